@@ -0,0 +1,120 @@
+#include "CoarseClock.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+    std::atomic<bool> running{false};
+    std::atomic<std::time_t> cachedSecond{0};
+    std::thread tickerThread;
+
+    // Preformatted cachedSecond behind a seqlock; only the ticker writes it.
+    // The NUL-terminated text is kept as relaxed atomic words, so a reader
+    // racing the ticker gets a torn copy the sequence check discards.
+    constexpr size_t kTextWords = 4;
+    constexpr size_t kTextBytes = kTextWords * sizeof(uint64_t);
+    std::atomic<uint32_t> textSequence{0};
+    std::atomic<uint64_t> cachedText[kTextWords] = {};
+
+    std::string formatNow(std::time_t t, const char *fmt)
+    {
+        std::tm tm{};
+#ifdef _WIN32
+        localtime_s(&tm, &t);
+#else
+        localtime_r(&t, &tm);
+#endif
+        char buf[64];
+        size_t len = std::strftime(buf, sizeof(buf), fmt, &tm);
+        return std::string(buf, len);
+    }
+
+    void refresh()
+    {
+        std::time_t t = std::time(nullptr);
+        if (t == cachedSecond.load(std::memory_order_relaxed))
+            return;
+
+        std::string text = formatNow(t, CoarseClock::kDefaultFormat);
+        uint32_t seq = textSequence.load(std::memory_order_relaxed);
+        textSequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        uint64_t raw[kTextWords] = {};
+        std::memcpy(raw, text.c_str(), std::min(text.size(), kTextBytes - 1));
+        for (size_t i = 0; i < kTextWords; ++i)
+            cachedText[i].store(raw[i], std::memory_order_relaxed);
+        cachedSecond.store(t, std::memory_order_relaxed);
+        textSequence.store(seq + 2, std::memory_order_release);
+    }
+
+    void tickerThreadFunc()
+    {
+        while (running.load(std::memory_order_relaxed))
+        {
+            refresh();
+            std::this_thread::sleep_for(std::chrono::milliseconds(CoarseClock::kTickMs));
+        }
+    }
+}
+
+void CoarseClock::start(const std::function<void(std::thread &)> &place)
+{
+    if (running.exchange(true))
+        return;
+    refresh();
+    tickerThread = std::thread(tickerThreadFunc);
+    if (place)
+        place(tickerThread);
+}
+
+void CoarseClock::stop()
+{
+    if (!running.exchange(false))
+        return;
+    if (tickerThread.joinable())
+        tickerThread.join();
+}
+
+std::time_t CoarseClock::now()
+{
+    if (!running.load(std::memory_order_relaxed))
+        return std::time(nullptr);
+    return cachedSecond.load(std::memory_order_relaxed);
+}
+
+std::string CoarseClock::format(std::time_t t, const char *fmt)
+{
+    if (fmt == kDefaultFormat && running.load(std::memory_order_relaxed))
+    {
+        while (true)
+        {
+            uint32_t before = textSequence.load(std::memory_order_acquire);
+            if (before & 1)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            bool cached = cachedSecond.load(std::memory_order_relaxed) == t;
+            uint64_t raw[kTextWords];
+            for (size_t i = 0; i < kTextWords; ++i)
+                raw[i] = cachedText[i].load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (textSequence.load(std::memory_order_relaxed) != before)
+                continue;
+            if (cached)
+            {
+                char text[kTextBytes];
+                std::memcpy(text, raw, sizeof(text));
+                return text;
+            }
+            break;
+        }
+    }
+    return formatNow(t, fmt);
+}
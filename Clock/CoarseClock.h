@@ -0,0 +1,29 @@
+#pragma once
+#include <ctime>
+#include <functional>
+#include <string>
+#include <thread>
+
+// Process-wide coarse wall clock. A ticker thread refreshes the current
+// epoch second and its preformatted text, so hot paths store a raw time_t
+// with one atomic load and text is only produced when something is shown.
+//
+// Until start() is called (e.g. in the offline tools) now() falls back to
+// std::time and every timestamp is formatted on demand.
+class CoarseClock
+{
+public:
+	static constexpr const char *kDefaultFormat = "%m/%d/%Y %H:%M:%S";
+	static constexpr int kTickMs = 100;
+
+	// place, if given, is called with the ticker thread once it exists
+	// (e.g. to pin it to the housekeeping CPUs)
+	static void start(const std::function<void(std::thread &)> &place = {});
+	static void stop();
+
+	static std::time_t now();
+
+	// Thread-safe; returns the cached text when t is the current second and
+	// the default format is asked for
+	static std::string format(std::time_t t, const char *fmt = kDefaultFormat);
+};
@@ -2,6 +2,8 @@
 
 AddCommand::AddCommand(const std::string& var1, const std::string& var2, const std::string& var3)
     : targetVar(var1), op1(var1), op2(var3) {
+    logFormat = "ADD: " + targetVar + " = " + operandPlaceholder(0) + " + " + operandPlaceholder(1) +
+                " = " + operandPlaceholder(2);
 }
 
 AddCommand::AddCommand(const std::string& var1, uint16_t value1, const std::string& operand2)
@@ -24,10 +26,13 @@ void AddCommand::execute(process& context) {
     context.variables[targetVar] = value1 + value2;
 
     // Optional: Log the result for debugging
-    std::stringstream ss;
-    ss << "ADD: " << targetVar << " = " << value1 << " + " << value2
-       << " = " << context.variables[targetVar];
-    context.addLog(ss);
+    LogRecord record;
+    record.source = this;
+    record.op = LogOp::Add;
+    record.operands[0] = value1;
+    record.operands[1] = value2;
+    record.operands[2] = context.variables[targetVar];
+    context.addLog(record);
 }
 
 uint16_t AddCommand::findValue(const std::string& varName, process& context) const {
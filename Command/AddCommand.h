@@ -12,6 +12,7 @@ public:
 	AddCommand(const std::string& var1, uint16_t value1, uint16_t value2); // both are value
 
 	void execute(process& context) override;
+	std::string_view logTemplate(const LogRecord&) const override { return logFormat; }
 	std::shared_ptr<Command> clone() const override {
 		return std::make_shared<AddCommand>(*this);
 	}
@@ -20,6 +21,7 @@ private:
 	std::string targetVar;
 	std::string op1;
 	std::string op2;
+	std::string logFormat;
 
 	uint16_t findValue(const std::string& varName, process& context) const;
 };
\ No newline at end of file
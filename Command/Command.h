@@ -1,11 +1,16 @@
 #pragma once  
 #include <memory>
+#include <string_view>
 
 class process;
+struct LogRecord;
 
 class Command {  
 public:  
     virtual void execute(process& context) = 0;  
     virtual std::shared_ptr<Command> clone() const = 0;
+    // Text of a log record this command appended, with operand placeholders
+    // (see formatLogRecord). Built once per command, never per record.
+    virtual std::string_view logTemplate(const LogRecord&) const { return {}; }
     virtual ~Command() = default;  
 };
\ No newline at end of file
@@ -1,32 +1,28 @@
 #include "PrintCommand.h"
 #include <fstream>
-#include <chrono>
 #include <ctime>
 #include <sstream>
 #include "myProcess.h"
-#include <thread>
+#include "console_sink.h"
+#include "CoarseClock.h"
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <stdexcept>
 
 PrintCommand::PrintCommand(uint16_t value) {
-    toPrint = std::to_string(value);
+    parse(std::to_string(value));
 }
 
-PrintCommand::PrintCommand() : toPrint("") {}
+PrintCommand::PrintCommand() {}
 
 PrintCommand::PrintCommand(const std::string& msg) {
-    toPrint = msg;
+    parse(msg);
 }
 
-void PrintCommand::execute(process& context) {
-    auto now = std::chrono::system_clock::now();
-    std::time_t timestamp = std::chrono::system_clock::to_time_t(now);
-
-    std::string evaluated = toPrint;
-    std::stringstream ss(evaluated);
+void PrintCommand::parse(const std::string& msg) {
+    std::stringstream ss(msg);
     std::string segment;
-    std::string finalMsg;
 
     while (std::getline(ss, segment, '+')) {
         segment.erase(0, segment.find_first_not_of(" \t"));
@@ -35,35 +31,40 @@ void PrintCommand::execute(process& context) {
         segment.erase(std::remove(segment.begin(), segment.end(), '\\'), segment.end());
 
         if (segment.size() >= 2 && segment.front() == '"' && segment.back() == '"') {
-            segment = segment.substr(1, segment.size() - 2);
-            finalMsg += segment;
+            logFormat += segment.substr(1, segment.size() - 2);
+            hasLiteralText = hasLiteralText || segment.size() > 2;
         } else {
-            auto it = context.variables.find(segment);
-            if (it != context.variables.end()) {
-                finalMsg += std::to_string(it->second);
-            } else {
-                finalMsg += "";  
+            if (variableNames.size() == LogRecord::kMaxOperands) {
+                throw std::invalid_argument("PRINT can show at most " + std::to_string(LogRecord::kMaxOperands) +
+                                            " variables");
             }
+            logFormat += operandPlaceholder(static_cast<int>(variableNames.size()));
+            variableNames.push_back(segment);
         }
     }
+}
 
-    // Create the log line
-    std::stringstream logLine;
-    logLine << "[Core " << context.getCoreId() << "] "
-            << std::put_time(std::localtime(&timestamp), "(%m/%d/%Y %H:%M:%S)") 
-            << ": " << finalMsg << "\n";
-
-    context.addLog(logLine);
-
-    if (!finalMsg.empty()) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-
-        std::cout << "\n" << logLine.str() << std::flush;
-        std::cout << "Enter command: " << std::flush;
+void PrintCommand::execute(process& context) {
+    LogRecord record;
+    record.source = this;
+    record.op = LogOp::Print;
 
+    // Variables that are not declared print as nothing
+    bool hasText = hasLiteralText;
+    for (size_t i = 0; i < variableNames.size(); ++i) {
+        auto it = context.variables.find(variableNames[i]);
+        if (it != context.variables.end()) {
+            record.operands[i] = it->second;
+            hasText = true;
+        } else {
+            record.missing |= 1 << i;
+        }
     }
 
-    if (delayTime > 0) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(delayTime));
+    context.addLog(record);
+
+    // Echoed by the console sink's thread; this never waits on the terminal
+    if (hasText) {
+        consoleSink().post(formatLogRecord(record, logFormat));
     }
 }
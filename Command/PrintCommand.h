@@ -2,6 +2,7 @@
 
 #include "Command.h"
 #include <string>
+#include <vector>
 
 class PrintCommand : public Command {
     public:
@@ -9,11 +10,19 @@ class PrintCommand : public Command {
 		PrintCommand();
         PrintCommand(const std::string& msg);
         void execute(process& context) override;
+        std::string_view logTemplate(const LogRecord&) const override { return logFormat; }
         std::shared_ptr<Command> clone() const override {
             return std::make_shared<PrintCommand>(*this);
         }
 
     private:
-        std::string toPrint;
-        int delayTime = 0;
-};
\ No newline at end of file
+        // The message is split on '+' once, at construction, into a log
+        // template and the variables it reads. Variable values go into the
+        // log record, so a message reading more than LogRecord::kMaxOperands
+        // variables is rejected with std::invalid_argument.
+        void parse(const std::string& msg);
+
+        std::string logFormat;
+        std::vector<std::string> variableNames;
+        bool hasLiteralText = false;
+};
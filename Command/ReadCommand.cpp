@@ -6,6 +6,10 @@
 ReadCommand::ReadCommand(const std::string &varName, uint16_t address)
     : variableName(varName), memoryAddress(address)
 {
+    std::stringstream ss;
+    ss << "READ: " << variableName << " = " << operandPlaceholder(0)
+       << " from address 0x" << std::hex << memoryAddress << std::dec;
+    logFormat = ss.str();
 }
 
 void ReadCommand::execute(process &context)
@@ -13,8 +17,9 @@ void ReadCommand::execute(process &context)
     uint16_t val = context.getMemoryManager()->readUint16(context.getPid(), memoryAddress);
     context.variables[variableName] = val;
 
-    std::stringstream ss;
-    ss << "READ: " << variableName << " = " << val
-       << " from address 0x" << std::hex << memoryAddress << std::dec;
-    context.addLog(ss);
+    LogRecord record;
+    record.source = this;
+    record.op = LogOp::Read;
+    record.operands[0] = val;
+    context.addLog(record);
 }
\ No newline at end of file
@@ -6,6 +6,7 @@ class ReadCommand : public Command {
 public:
     ReadCommand(const std::string& varName, uint16_t address);
     void execute(process& context) override;
+    std::string_view logTemplate(const LogRecord&) const override { return logFormat; }
     std::shared_ptr<Command> clone() const override {
         return std::make_shared<ReadCommand>(*this);
     }
@@ -13,4 +14,5 @@ public:
 private:
     std::string variableName;
     uint16_t memoryAddress;
+    std::string logFormat;
 };
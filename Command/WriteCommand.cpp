@@ -6,6 +6,10 @@
 WriteCommand::WriteCommand(uint16_t address, const std::string &varName)
     : memoryAddress(address), variableName(varName)
 {
+    std::stringstream ss;
+    ss << "WRITE: " << operandPlaceholder(0) << " to address 0x" << std::hex << memoryAddress << std::dec;
+    logFormat = ss.str();
+    errorFormat = "WRITE ERROR: Variable '" + variableName + "' not found";
 }
 
 void WriteCommand::execute(process &context)
@@ -14,16 +18,24 @@ void WriteCommand::execute(process &context)
     auto it = context.variables.find(variableName);
     if (it == context.variables.end())
     {
-        std::stringstream ss;
-        ss << "WRITE ERROR: Variable '" << variableName << "' not found";
-        context.addLog(ss);
+        LogRecord record;
+        record.source = this;
+        record.op = LogOp::WriteError;
+        context.addLog(record);
         return;
     }
 
     uint16_t value = it->second;
     context.getMemoryManager()->writeUint16(context.getPid(), memoryAddress, value);
 
-    std::stringstream ss;
-    ss << "WRITE: " << value << " to address 0x" << std::hex << memoryAddress << std::dec;
-    context.addLog(ss);
+    LogRecord record;
+    record.source = this;
+    record.op = LogOp::Write;
+    record.operands[0] = value;
+    context.addLog(record);
+}
+
+std::string_view WriteCommand::logTemplate(const LogRecord &record) const
+{
+    return record.op == LogOp::WriteError ? errorFormat : logFormat;
 }
\ No newline at end of file
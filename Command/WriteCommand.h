@@ -6,6 +6,7 @@ class WriteCommand : public Command {
 public:
     WriteCommand(uint16_t address, const std::string& varName);
     void execute(process& context) override;
+    std::string_view logTemplate(const LogRecord& record) const override;
     std::shared_ptr<Command> clone() const override {
         return std::make_shared<WriteCommand>(*this);
     }
@@ -13,4 +14,6 @@ public:
 private:
     uint16_t memoryAddress;
     std::string variableName;
+    std::string logFormat;
+    std::string errorFormat;
 };
@@ -6,10 +6,49 @@
 #include <iostream>
 #include <iomanip>
 #include <filesystem>
+#include <vector>
+#include <cctype>
 
 namespace fs = std::filesystem;
 using namespace std;
 
+vector<int> parseCpuList(const string& list) {
+    auto toCpu = [&list](const string& text) {
+        size_t used = 0;
+        int cpu = -1;
+        try {
+            cpu = stoi(text, &used);
+        }
+        catch (const logic_error&) {
+            used = 0;
+        }
+        if (used == 0 || used != text.size() || cpu < 0 || cpu > 4095) {
+            throw invalid_argument("Invalid CPU list '" + list + "'");
+        }
+        return cpu;
+    };
+
+    vector<int> cpus;
+    istringstream iss(list);
+    string range;
+    while (getline(iss, range, ',')) {
+        range.erase(remove_if(range.begin(), range.end(), [](unsigned char c) { return isspace(c); }), range.end());
+        if (range.empty()) {
+            continue;
+        }
+        size_t dash = range.find('-');
+        int first = toCpu(range.substr(0, dash));
+        int last = dash == string::npos ? first : toCpu(range.substr(dash + 1));
+        if (last < first) {
+            throw invalid_argument("Invalid CPU list '" + list + "'");
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
 Config::Config(const string& filename) :
     numCPU(0),
     schedulerAlgorithm(SchedulerAlgorithm::FCFS),
@@ -21,7 +60,20 @@ Config::Config(const string& filename) :
     maxOverallMem(0),
     memPerFrame(0),
 	minMemPerProc(0),
-	maxMemPerProc(0)
+	maxMemPerProc(0),
+    pageFaultLatency(0),
+    placementPolicy(PlacementPolicy::FirstFit),
+    logCapacity(100),
+    mlfqLevels(3),
+    mlfqBoostInterval(100),
+    randomSeed(1),
+    defaultTickets(100),
+    batchDeadline(0),
+    migrationCost(0),
+    numaPlacement(NumaPlacement::None),
+    adaptiveQuantum(false),
+    quantumMin(1),
+    quantumMax(100)
 {
 
     std::vector<fs::path> possiblePaths = {
@@ -69,6 +121,24 @@ Config::Config(const string& filename) :
                 else if (algo == "rr") {
                     schedulerAlgorithm = SchedulerAlgorithm::RR;
                 }
+                else if (algo == "prio") {
+                    schedulerAlgorithm = SchedulerAlgorithm::PRIO;
+                }
+                else if (algo == "mlfq") {
+                    schedulerAlgorithm = SchedulerAlgorithm::MLFQ;
+                }
+                else if (algo == "sjf") {
+                    schedulerAlgorithm = SchedulerAlgorithm::SJF;
+                }
+                else if (algo == "srtf") {
+                    schedulerAlgorithm = SchedulerAlgorithm::SRTF;
+                }
+                else if (algo == "stride") {
+                    schedulerAlgorithm = SchedulerAlgorithm::STRIDE;
+                }
+                else if (algo == "edf") {
+                    schedulerAlgorithm = SchedulerAlgorithm::EDF;
+                }
                 else {
                     throw invalid_argument("Invalid scheduler algorithm");
                 }
@@ -130,9 +200,171 @@ Config::Config(const string& filename) :
                     throw out_of_range("mem-per-proc must be between 64 and 65536");
                 }
             }
+            else if (key == "page-fault-latency") {
+                iss >> pageFaultLatency;
+                if (pageFaultLatency < 0 || pageFaultLatency > 65536) {
+                    throw out_of_range("page-fault-latency must be between 0 and 65536");
+                }
+            }
+            else if (key == "placement-policy") {
+                string policy;
+                iss >> policy;
+                policy.erase(remove(policy.begin(), policy.end(), '"'), policy.end());
+
+                if (policy == "first-fit") {
+                    placementPolicy = PlacementPolicy::FirstFit;
+                }
+                else if (policy == "best-fit") {
+                    placementPolicy = PlacementPolicy::BestFit;
+                }
+                else if (policy == "worst-fit") {
+                    placementPolicy = PlacementPolicy::WorstFit;
+                }
+                else if (policy == "next-fit") {
+                    placementPolicy = PlacementPolicy::NextFit;
+                }
+                else {
+                    throw invalid_argument("Invalid placement policy");
+                }
+            }
+            else if (key == "log-capacity") {
+                iss >> logCapacity;
+                if (logCapacity < 0 || logCapacity > 65536) {
+                    throw out_of_range("log-capacity must be between 0 and 65536");
+                }
+            }
+            else if (key == "mlfq-levels") {
+                iss >> mlfqLevels;
+                if (mlfqLevels < 1 || mlfqLevels > 16) {
+                    throw out_of_range("mlfq-levels must be between 1 and 16");
+                }
+            }
+            else if (key == "mlfq-quanta") {
+                mlfqQuanta.clear();
+                int quantum;
+                while (iss >> quantum) {
+                    if (quantum < 1 || quantum > 65536) {
+                        throw out_of_range("mlfq-quanta entries must be between 1 and 65536");
+                    }
+                    mlfqQuanta.push_back(quantum);
+                }
+            }
+            else if (key == "mlfq-boost-interval") {
+                iss >> mlfqBoostInterval;
+                if (mlfqBoostInterval < 0 || mlfqBoostInterval > 65536) {
+                    throw out_of_range("mlfq-boost-interval must be between 0 and 65536");
+                }
+            }
+            else if (key == "random-seed") {
+                long long seed;
+                iss >> seed;
+                if (seed < 0 || seed > 4294967295LL) {
+                    throw out_of_range("random-seed must be between 0 and 4294967295");
+                }
+                randomSeed = static_cast<unsigned int>(seed);
+            }
+            else if (key == "default-tickets") {
+                iss >> defaultTickets;
+                if (defaultTickets < 1 || defaultTickets > 10000) {
+                    throw out_of_range("default-tickets must be between 1 and 10000");
+                }
+            }
+            else if (key == "group-tickets") {
+                string group;
+                int tickets = 0;
+                iss >> group >> tickets;
+                group.erase(remove(group.begin(), group.end(), '"'), group.end());
+                if (group.empty() || tickets < 1 || tickets > 10000) {
+                    throw out_of_range("group-tickets needs a group name and 1 to 10000 tickets");
+                }
+                groupTickets.emplace_back(group, tickets);
+            }
+            else if (key == "batch-deadline") {
+                iss >> batchDeadline;
+                if (batchDeadline < 0 || batchDeadline > 1000000000) {
+                    throw out_of_range("batch-deadline must be between 0 and 1000000000");
+                }
+            }
+            else if (key == "migration-cost") {
+                iss >> migrationCost;
+                if (migrationCost < 0 || migrationCost > 65536) {
+                    throw out_of_range("migration-cost must be between 0 and 65536");
+                }
+            }
+            else if (key == "worker-cpus" || key == "housekeeping-cpus") {
+                string list;
+                getline(iss, list);
+                list.erase(remove(list.begin(), list.end(), '"'), list.end());
+                (key == "worker-cpus" ? workerCpus : housekeepingCpus) = parseCpuList(list);
+            }
+            else if (key == "numa-placement") {
+                string placement;
+                iss >> placement;
+                placement.erase(remove(placement.begin(), placement.end(), '"'), placement.end());
+
+                if (placement == "none") {
+                    numaPlacement = NumaPlacement::None;
+                }
+                else if (placement == "compact") {
+                    numaPlacement = NumaPlacement::Compact;
+                }
+                else if (placement == "spread") {
+                    numaPlacement = NumaPlacement::Spread;
+                }
+                else {
+                    throw invalid_argument("Invalid NUMA placement");
+                }
+            }
+            else if (key == "quantum-mode") {
+                string mode;
+                iss >> mode;
+                mode.erase(remove(mode.begin(), mode.end(), '"'), mode.end());
+
+                if (mode == "fixed") {
+                    adaptiveQuantum = false;
+                }
+                else if (mode == "adaptive") {
+                    adaptiveQuantum = true;
+                }
+                else {
+                    throw invalid_argument("Invalid quantum mode");
+                }
+            }
+            else if (key == "quantum-min") {
+                iss >> quantumMin;
+                if (quantumMin < 1 || quantumMin > 65536) {
+                    throw out_of_range("quantum-min must be between 1 and 65536");
+                }
+            }
+            else if (key == "quantum-max") {
+                iss >> quantumMax;
+                if (quantumMax < 1 || quantumMax > 65536) {
+                    throw out_of_range("quantum-max must be between 1 and 65536");
+                }
+            }
         }
     }
     file.close();
+
+    if (quantumMax < quantumMin) {
+        throw out_of_range("quantum-max must be >= quantum-min");
+    }
+    if (mlfqQuanta.size() > static_cast<size_t>(mlfqLevels)) {
+        throw out_of_range("mlfq-quanta lists more entries than mlfq-levels");
+    }
+}
+
+// Quanta listed in the config, extended to every level by doubling the last
+// one; with none listed level 0 uses quantum-cycles (at least 1)
+vector<int> Config::getMlfqQuanta() const {
+    vector<int> quanta = mlfqQuanta;
+    if (quanta.empty()) {
+        quanta.push_back(max(quantumCycles, 1));
+    }
+    while (quanta.size() < static_cast<size_t>(mlfqLevels)) {
+        quanta.push_back(min(quanta.back() * 2, 65536));
+    }
+    return quanta;
 }
 
 void Config::printConfig() const {
@@ -142,10 +374,37 @@ void Config::printConfig() const {
     cout << left << setw(colWidth) << "Number of CPUs:" << numCPU << "\n";
 
     cout << setw(colWidth) << "Scheduler Algorithm:"
-        << (schedulerAlgorithm == SchedulerAlgorithm::FCFS ? "FCFS" : "Round Robin") << "\n";
+        << schedulerAlgorithmName(schedulerAlgorithm) << "\n";
 
-    if (schedulerAlgorithm == SchedulerAlgorithm::RR) {
+    if (schedulerAlgorithm == SchedulerAlgorithm::RR && adaptiveQuantum) {
+        cout << setw(colWidth) << "Quantum Cycles:" << "adaptive, " << quantumMin << " to " << quantumMax << "\n";
+    }
+    else if (schedulerAlgorithm == SchedulerAlgorithm::RR) {
+        cout << setw(colWidth) << "Quantum Cycles:" << quantumCycles << "\n";
+    }
+    else if (schedulerAlgorithm == SchedulerAlgorithm::MLFQ) {
+        cout << setw(colWidth) << "MLFQ Quanta:";
+        for (int quantum : getMlfqQuanta()) {
+            cout << quantum << " ";
+        }
+        cout << "cycles\n";
+        cout << setw(colWidth) << "MLFQ Boost Interval:" << mlfqBoostInterval << " dispatches\n";
+    }
+    else if (schedulerAlgorithm == SchedulerAlgorithm::STRIDE) {
         cout << setw(colWidth) << "Quantum Cycles:" << quantumCycles << "\n";
+        cout << setw(colWidth) << "Default Tickets:" << defaultTickets << "\n";
+        for (const auto &[group, tickets] : groupTickets) {
+            cout << setw(colWidth) << ("Group " + group + ":") << tickets << " tickets\n";
+        }
+    }
+    else if (schedulerAlgorithm == SchedulerAlgorithm::EDF) {
+        cout << setw(colWidth) << "Batch Deadline:";
+        if (batchDeadline > 0) {
+            cout << batchDeadline << " cycles\n";
+        }
+        else {
+            cout << "none\n";
+        }
     }
 
     cout << setw(colWidth) << "Batch Process Frequency:" << batchProcessFreq << " cycles\n";
@@ -156,5 +415,24 @@ void Config::printConfig() const {
 	cout << setw(colWidth) << "Memory per Frame:" << memPerFrame << " KB\n";
 	cout << setw(colWidth) << "Min Memory per Process:" << minMemPerProc << " KB\n";
 	cout << setw(colWidth) << "Max Memory per Process:" << maxMemPerProc << " KB\n";
+	cout << setw(colWidth) << "Page Fault Latency:" << pageFaultLatency << " cycles\n";
+	cout << setw(colWidth) << "Placement Policy:" << placementPolicyName(placementPolicy) << "\n";
+	cout << setw(colWidth) << "Log Capacity:" << logCapacity << " entries\n";
+	cout << setw(colWidth) << "Random Seed:" << randomSeed << "\n";
+	cout << setw(colWidth) << "Migration Cost:" << migrationCost << " cycles\n";
+	auto printCpus = [](const vector<int>& cpus) {
+		if (cpus.empty()) {
+			cout << "any";
+		}
+		for (size_t i = 0; i < cpus.size(); ++i) {
+			cout << (i ? "," : "") << cpus[i];
+		}
+		cout << "\n";
+	};
+	cout << setw(colWidth) << "Worker CPUs:";
+	printCpus(workerCpus);
+	cout << setw(colWidth) << "Housekeeping CPUs:";
+	printCpus(housekeepingCpus);
+	cout << setw(colWidth) << "NUMA Placement:" << numaPlacementName(numaPlacement) << "\n";
     cout << "===========================\n";
 }
\ No newline at end of file
@@ -2,13 +2,92 @@
 #define CONFIG_H
 
 #include <string>
+#include <utility>
+#include <vector>
 
 enum class SchedulerAlgorithm
 {
 	FCFS,
-	RR
+	RR,
+	PRIO, // preemptive priority
+	MLFQ, // multi-level feedback queue
+	SJF,  // shortest job first, non-preemptive
+	SRTF, // shortest remaining time first
+	STRIDE, // proportional share by tickets and groups
+	EDF     // earliest deadline first
 };
 
+inline const char *schedulerAlgorithmName(SchedulerAlgorithm algorithm)
+{
+	switch (algorithm)
+	{
+	case SchedulerAlgorithm::RR:
+		return "Round Robin";
+	case SchedulerAlgorithm::PRIO:
+		return "Preemptive Priority";
+	case SchedulerAlgorithm::MLFQ:
+		return "Multi-Level Feedback Queue";
+	case SchedulerAlgorithm::SJF:
+		return "Shortest Job First";
+	case SchedulerAlgorithm::SRTF:
+		return "Shortest Remaining Time First";
+	case SchedulerAlgorithm::STRIDE:
+		return "Stride";
+	case SchedulerAlgorithm::EDF:
+		return "Earliest Deadline First";
+	default:
+		return "FCFS";
+	}
+}
+
+enum class PlacementPolicy
+{
+	FirstFit,
+	BestFit,
+	WorstFit,
+	NextFit
+};
+
+inline const char *placementPolicyName(PlacementPolicy policy)
+{
+	switch (policy)
+	{
+	case PlacementPolicy::BestFit:
+		return "best-fit";
+	case PlacementPolicy::WorstFit:
+		return "worst-fit";
+	case PlacementPolicy::NextFit:
+		return "next-fit";
+	default:
+		return "first-fit";
+	}
+}
+
+// Host thread placement of the emulated cores; see HostPlacement
+enum class NumaPlacement
+{
+	None,    // keep worker-cpus in the order given
+	Compact, // fill one NUMA node before the next
+	Spread   // alternate workers across nodes
+};
+
+inline const char *numaPlacementName(NumaPlacement placement)
+{
+	switch (placement)
+	{
+	case NumaPlacement::Compact:
+		return "compact";
+	case NumaPlacement::Spread:
+		return "spread";
+	default:
+		return "none";
+	}
+}
+
+// Parses a Linux-style CPU list such as "0-3,8,10-11"; throws
+// invalid_argument on malformed input
+std::vector<int> parseCpuList(const std::string &list);
+
 class Config
 {
 
@@ -24,6 +103,23 @@ private:
 	int memPerFrame;
 	int minMemPerProc;
 	int maxMemPerProc;
+	int pageFaultLatency;
+	PlacementPolicy placementPolicy;
+	int logCapacity;
+	int mlfqLevels;
+	std::vector<int> mlfqQuanta; // as listed; missing levels are derived
+	int mlfqBoostInterval;
+	unsigned int randomSeed;
+	int defaultTickets;
+	std::vector<std::pair<std::string, int>> groupTickets; // group-tickets lines, in file order
+	int batchDeadline;
+	int migrationCost;
+	std::vector<int> workerCpus;
+	std::vector<int> housekeepingCpus;
+	NumaPlacement numaPlacement;
+	bool adaptiveQuantum;
+	int quantumMin;
+	int quantumMax;
 
 public:
 	Config(const std::string &filename);
@@ -40,6 +136,23 @@ public:
 	int getMemPerFrame() const { return memPerFrame; }
 	int getMinMemPerProc() const { return minMemPerProc; }
 	int getMaxMemPerProc() const { return maxMemPerProc; }
+	int getPageFaultLatency() const { return pageFaultLatency; }
+	PlacementPolicy getPlacementPolicy() const { return placementPolicy; }
+	int getLogCapacity() const { return logCapacity; }
+	int getMlfqLevels() const { return mlfqLevels; }
+	std::vector<int> getMlfqQuanta() const;
+	int getMlfqBoostInterval() const { return mlfqBoostInterval; }
+	unsigned int getRandomSeed() const { return randomSeed; }
+	int getDefaultTickets() const { return defaultTickets; }
+	const std::vector<std::pair<std::string, int>> &getGroupTickets() const { return groupTickets; }
+	int getBatchDeadline() const { return batchDeadline; }
+	int getMigrationCost() const { return migrationCost; }
+	const std::vector<int> &getWorkerCpus() const { return workerCpus; }
+	const std::vector<int> &getHousekeepingCpus() const { return housekeepingCpus; }
+	NumaPlacement getNumaPlacement() const { return numaPlacement; }
+	bool isAdaptiveQuantum() const { return adaptiveQuantum; }
+	int getQuantumMin() const { return quantumMin; }
+	int getQuantumMax() const { return quantumMax; }
 };
 
 #endif
\ No newline at end of file
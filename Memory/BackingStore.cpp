@@ -0,0 +1,228 @@
+#include "BackingStore.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+    const int kMinSlotBytes = 16;
+    const int kSlotsPerChunk = 64;
+    const uint16_t kRunFlag = 0x8000;
+    const int kMaxTokenCount = 0x7FFF;
+
+    void putWord(uint8_t *out, size_t &pos, uint16_t word)
+    {
+        out[pos++] = word & 0xFF;
+        out[pos++] = (word >> 8) & 0xFF;
+    }
+
+    uint16_t getWord(const uint8_t *in, size_t &pos)
+    {
+        uint16_t word = in[pos] | (in[pos + 1] << 8);
+        pos += 2;
+        return word;
+    }
+
+    long long elapsedNanos(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+BackingStore::BackingStore(int pageBytes)
+    : numWords((pageBytes + 1) / 2), scratch(4 * ((pageBytes + 1) / 2) + 4)
+{
+    int rawBytes = numWords * 2;
+    for (int slotBytes = kMinSlotBytes;; slotBytes <<= 1)
+    {
+        slabs.push_back({slotBytes, {}, {}});
+        if (slotBytes >= rawBytes)
+            break;
+    }
+}
+
+void BackingStore::store(int pid, int pageNum, const uint16_t *words)
+{
+    auto start = std::chrono::steady_clock::now();
+    erase(pid, pageNum);
+
+    SwapSlot entry{Encoding::Zero, 0, 0, 0};
+    bool allZero = std::all_of(words, words + numWords, [](uint16_t w)
+                               { return w == 0; });
+    if (!allZero)
+    {
+        size_t length = encodeRle(words);
+        const uint8_t *source = scratch.data();
+        entry.encoding = Encoding::Rle;
+        if (length >= static_cast<size_t>(numWords) * 2)
+        {
+            // Incompressible: keep the page as-is
+            length = numWords * 2;
+            source = reinterpret_cast<const uint8_t *>(words);
+            entry.encoding = Encoding::Raw;
+        }
+
+        int sizeClass = 0;
+        while (slabs[sizeClass].slotBytes < static_cast<int>(length))
+            ++sizeClass;
+
+        entry.sizeClass = static_cast<uint8_t>(sizeClass);
+        entry.slot = allocateSlot(sizeClass);
+        entry.length = static_cast<uint32_t>(length);
+        std::memcpy(slotData(entry), source, length);
+        stats.storedBytes += slabs[sizeClass].slotBytes;
+    }
+    else
+    {
+        stats.zeroPages++;
+    }
+
+    index[key(pid, pageNum)] = entry;
+    stats.pagesStored++;
+    stats.rawBytes += numWords * 2;
+    stats.compressions++;
+    stats.compressNanos += elapsedNanos(start);
+}
+
+bool BackingStore::load(int pid, int pageNum, uint16_t *words)
+{
+    auto it = index.find(key(pid, pageNum));
+    if (it == index.end())
+        return false;
+
+    auto start = std::chrono::steady_clock::now();
+    decode(it->second, words);
+    release(it->second);
+    index.erase(it);
+    stats.decompressions++;
+    stats.decompressNanos += elapsedNanos(start);
+    return true;
+}
+
+void BackingStore::erase(int pid, int pageNum)
+{
+    auto it = index.find(key(pid, pageNum));
+    if (it == index.end())
+        return;
+    release(it->second);
+    index.erase(it);
+}
+
+size_t BackingStore::encodeRle(const uint16_t *words)
+{
+    // Token words: high bit set = run of (token & 0x7FFF) copies of the next
+    // word, otherwise a literal block of token words follows.
+    uint8_t *out = scratch.data();
+    size_t pos = 0;
+    int literalStart = 0;
+    int i = 0;
+
+    auto flushLiterals = [&](int end)
+    {
+        while (literalStart < end)
+        {
+            int count = std::min(end - literalStart, kMaxTokenCount);
+            putWord(out, pos, static_cast<uint16_t>(count));
+            for (int j = 0; j < count; ++j)
+                putWord(out, pos, words[literalStart + j]);
+            literalStart += count;
+        }
+    };
+
+    while (i < numWords)
+    {
+        int run = 1;
+        while (i + run < numWords && run < kMaxTokenCount && words[i + run] == words[i])
+            ++run;
+
+        if (run >= 3)
+        {
+            flushLiterals(i);
+            putWord(out, pos, static_cast<uint16_t>(kRunFlag | run));
+            putWord(out, pos, words[i]);
+            i += run;
+            literalStart = i;
+        }
+        else
+        {
+            i += run;
+        }
+    }
+    flushLiterals(numWords);
+    return pos;
+}
+
+void BackingStore::decode(const SwapSlot &entry, uint16_t *words) const
+{
+    if (entry.encoding == Encoding::Zero)
+    {
+        std::fill(words, words + numWords, 0);
+        return;
+    }
+
+    const uint8_t *in = slotData(entry);
+    if (entry.encoding == Encoding::Raw)
+    {
+        std::memcpy(words, in, numWords * 2);
+        return;
+    }
+
+    size_t pos = 0;
+    int out = 0;
+    while (pos < entry.length && out < numWords)
+    {
+        uint16_t token = getWord(in, pos);
+        int count = token & kMaxTokenCount;
+        if (token & kRunFlag)
+        {
+            uint16_t value = getWord(in, pos);
+            std::fill(words + out, words + out + count, value);
+            out += count;
+        }
+        else
+        {
+            for (int j = 0; j < count; ++j)
+                words[out++] = getWord(in, pos);
+        }
+    }
+}
+
+uint32_t BackingStore::allocateSlot(int sizeClass)
+{
+    Slab &slab = slabs[sizeClass];
+    if (slab.freeSlots.empty())
+    {
+        uint32_t first = static_cast<uint32_t>(slab.arena.size() / slab.slotBytes);
+        slab.arena.resize(slab.arena.size() + static_cast<size_t>(slab.slotBytes) * kSlotsPerChunk);
+        for (int i = kSlotsPerChunk - 1; i >= 0; --i)
+            slab.freeSlots.push_back(first + i);
+    }
+    uint32_t slot = slab.freeSlots.back();
+    slab.freeSlots.pop_back();
+    return slot;
+}
+
+void BackingStore::release(const SwapSlot &entry)
+{
+    if (entry.encoding == Encoding::Zero)
+        stats.zeroPages--;
+    else
+    {
+        slabs[entry.sizeClass].freeSlots.push_back(entry.slot);
+        stats.storedBytes -= slabs[entry.sizeClass].slotBytes;
+    }
+    stats.pagesStored--;
+    stats.rawBytes -= numWords * 2;
+}
+
+uint8_t *BackingStore::slotData(const SwapSlot &entry)
+{
+    Slab &slab = slabs[entry.sizeClass];
+    return slab.arena.data() + static_cast<size_t>(entry.slot) * slab.slotBytes;
+}
+
+const uint8_t *BackingStore::slotData(const SwapSlot &entry) const
+{
+    const Slab &slab = slabs[entry.sizeClass];
+    return slab.arena.data() + static_cast<size_t>(entry.slot) * slab.slotBytes;
+}
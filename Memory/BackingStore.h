@@ -0,0 +1,88 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+// Compressed swap tier for evicted pages.
+//
+// All-zero pages are elided entirely. Other pages are run-length encoded over
+// 16-bit words (falling back to a raw copy when that does not help) and the
+// result is kept in a slab of the smallest size class that fits. Callers are
+// expected to hold the MemoryManager lock.
+class BackingStore
+{
+public:
+    struct Stats
+    {
+        long long pagesStored = 0;
+        long long zeroPages = 0;
+        long long rawBytes = 0;    // uncompressed size of the pages currently stored
+        long long storedBytes = 0; // slab bytes currently in use
+        long long compressions = 0;
+        long long decompressions = 0;
+        long long compressNanos = 0;
+        long long decompressNanos = 0;
+    };
+
+    explicit BackingStore(int pageBytes);
+
+    void store(int pid, int pageNum, const uint16_t *words);
+    bool load(int pid, int pageNum, uint16_t *words); // removes the page; false if absent
+    void erase(int pid, int pageNum);
+
+    // Decompress every stored page, for dumps. fn(pid, pageNum, words)
+    template <typename Func>
+    void forEachPage(Func fn) const
+    {
+        std::vector<uint16_t> words(numWords);
+        for (const auto &entry : index)
+        {
+            decode(entry.second, words.data());
+            fn(static_cast<int>(entry.first >> 32), static_cast<int>(entry.first & 0xFFFFFFFFu), words);
+        }
+    }
+
+    const Stats &getStats() const { return stats; }
+
+private:
+    enum class Encoding : uint8_t
+    {
+        Zero,
+        Rle,
+        Raw
+    };
+
+    struct SwapSlot
+    {
+        Encoding encoding;
+        uint8_t sizeClass;
+        uint32_t slot;
+        uint32_t length; // encoded bytes
+    };
+
+    struct Slab
+    {
+        int slotBytes;
+        std::vector<uint8_t> arena;
+        std::vector<uint32_t> freeSlots;
+    };
+
+    static uint64_t key(int pid, int pageNum)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(pid)) << 32) | static_cast<uint32_t>(pageNum);
+    }
+
+    int numWords;
+    std::vector<uint8_t> scratch; // encode buffer, reused across calls
+    std::vector<Slab> slabs;      // slabs[k] holds slots of 16 << k bytes
+    std::unordered_map<uint64_t, SwapSlot> index;
+    Stats stats;
+
+    size_t encodeRle(const uint16_t *words);
+    void decode(const SwapSlot &entry, uint16_t *words) const;
+    uint32_t allocateSlot(int sizeClass);
+    void release(const SwapSlot &entry);
+    uint8_t *slotData(const SwapSlot &entry);
+    const uint8_t *slotData(const SwapSlot &entry) const;
+};
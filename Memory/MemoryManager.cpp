@@ -2,145 +2,240 @@
 #include <algorithm>
 #include <iostream> // Added for diagnostic prints
 #include <string>
+#include <stdexcept>
 
-MemoryManager::MemoryManager(int totalBytes, int frameBytes)
-    : totalBytes(totalBytes), frameBytes(frameBytes)
+MemoryManager::MemoryManager(int totalBytes, int frameBytes, PlacementPolicy policy)
+    : totalBytes(totalBytes), frameBytes(frameBytes), placementPolicy(policy), backingStore(frameBytes)
 {
     totalFrames = totalBytes / frameBytes;
-    blocks.push_back({0, totalFrames, -1}); // all memory is free at start
+    freeLists.resize(sizeClassOf(std::max(totalFrames, 1)) + 1);
+    freeFramesByClass.assign(freeLists.size(), 0);
+    addFreeBlock(0, totalFrames); // all memory is free at start
+
+    memory.assign(totalFrames * frameBytes / 2 + 1, 0);
+    pageTablePool.assign(totalFrames, {-1, false, false});
+    frameOwners.assign(totalFrames, kNoOwner);
 }
 
-bool MemoryManager::allocate(int processId, int bytes)
+int MemoryManager::sizeClassOf(int frames)
 {
-    std::lock_guard<std::mutex> lock(mtx);
-    int neededFrames = (bytes + frameBytes - 1) / frameBytes;
-
-    for (size_t i = 0; i < blocks.size(); ++i) // Use index instead of iterator
+    int sizeClass = 0;
+    while (frames > 1)
     {
-        if (blocks[i].ownerPid == -1 && blocks[i].numFrames >= neededFrames)
-        {
-            // First-fit found
-            int start = blocks[i].startFrame;
+        frames >>= 1;
+        ++sizeClass;
+    }
+    return sizeClass;
+}
 
-            // Split block if needed
-            if (blocks[i].numFrames > neededFrames)
-            {
-                // Insert new block AFTER current block
-                blocks.insert(blocks.begin() + i + 1,
-                              {start + neededFrames, blocks[i].numFrames - neededFrames, -1});
-            }
+void MemoryManager::addFreeBlock(int startFrame, int numFrames)
+{
+    if (numFrames <= 0)
+        return;
+    blocks[startFrame] = {startFrame, numFrames, -1};
+    FreeList &list = freeLists[sizeClassOf(numFrames)];
+    list.byAddress[startFrame] = numFrames;
+    list.bySize.insert({numFrames, startFrame});
+    freeFramesByClass[sizeClassOf(numFrames)] += numFrames;
+    freeFrames += numFrames;
+}
 
-            // Update current block
-            blocks[i].numFrames = neededFrames;
-            blocks[i].ownerPid = processId;
+void MemoryManager::removeFreeBlock(int startFrame, int numFrames)
+{
+    blocks.erase(startFrame);
+    FreeList &list = freeLists[sizeClassOf(numFrames)];
+    list.byAddress.erase(startFrame);
+    list.bySize.erase({numFrames, startFrame});
+    freeFramesByClass[sizeClassOf(numFrames)] -= numFrames;
+    freeFrames -= numFrames;
+}
 
-            numPagedIn += neededFrames;
+int MemoryManager::firstFitFrom(int neededFrames, int fromFrame) const
+{
+    int best = -1;
+    int firstClass = sizeClassOf(neededFrames);
 
-            return true;
+    // The smallest class may hold blocks that are too small, so walk it in
+    // address order; every block in a larger class fits.
+    const auto &exact = freeLists[firstClass].byAddress;
+    for (auto it = exact.lower_bound(fromFrame); it != exact.end(); ++it)
+    {
+        if (it->second >= neededFrames)
+        {
+            best = it->first;
+            break;
         }
     }
 
-    return false; // no suitable block
+    for (size_t k = firstClass + 1; k < freeLists.size(); ++k)
+    {
+        const auto &byAddress = freeLists[k].byAddress;
+        auto it = byAddress.lower_bound(fromFrame);
+        if (it != byAddress.end() && (best == -1 || it->first < best))
+            best = it->first;
+    }
+    return best;
 }
 
-void MemoryManager::free(int processId)
+int MemoryManager::findFreeBlock(int neededFrames) const
 {
-    std::lock_guard<std::mutex> lock(mtx);
+    if (neededFrames <= 0 || neededFrames > totalFrames)
+        return -1;
 
-    int frames = 0;
-    for (const auto &block : blocks)
+    switch (placementPolicy)
     {
-        if (block.ownerPid == processId)
-            frames += block.numFrames;
-    }
+    case PlacementPolicy::BestFit:
+        // Classes are ordered by size, so the first fit found is the tightest
+        for (size_t k = sizeClassOf(neededFrames); k < freeLists.size(); ++k)
+        {
+            const auto &bySize = freeLists[k].bySize;
+            auto it = bySize.lower_bound({neededFrames, -1});
+            if (it != bySize.end())
+                return it->second;
+        }
+        return -1;
 
-    for (auto &block : blocks)
-    {
-        if (block.ownerPid == processId)
+    case PlacementPolicy::WorstFit:
+        for (size_t k = freeLists.size(); k-- > 0;)
         {
-            block.ownerPid = -1;
+            const auto &bySize = freeLists[k].bySize;
+            if (!bySize.empty())
+                return bySize.rbegin()->first >= neededFrames ? bySize.rbegin()->second : -1;
         }
+        return -1;
+
+    case PlacementPolicy::NextFit:
+    {
+        int start = firstFitFrom(neededFrames, nextFitRover);
+        return start != -1 ? start : firstFitFrom(neededFrames, 0);
     }
 
-    numPagedOut += frames;
-    mergeFreeBlocks();
+    case PlacementPolicy::FirstFit:
+    default:
+        return firstFitFrom(neededFrames, 0);
+    }
 }
 
-int MemoryManager::getTotalFreeMemory() const
+PageTableEntry &MemoryManager::pageTableEntry(int pid, int pageNum)
 {
-    std::lock_guard<std::mutex> lock(mtx);
-    int freeFrames = 0;
-    for (const auto &block : blocks)
+    if (pid < 0 || static_cast<size_t>(pid) >= pageTableIndex.size() ||
+        pageNum < 0 || pageNum >= pageTableIndex[pid].numPages)
     {
-        if (block.ownerPid == -1)
-            freeFrames += block.numFrames;
+        throw std::out_of_range("Memory access violation: process " + std::to_string(pid) +
+                                " accessed page " + std::to_string(pageNum));
     }
-    return freeFrames * frameBytes;
+    return pageTablePool[pageTableIndex[pid].base + pageNum];
 }
 
-int MemoryManager::getFramesPerProcess(int processId) const
+void MemoryManager::resetPageTable(int pid)
 {
-    std::lock_guard<std::mutex> lock(mtx);
-    int frames = 0;
-    for (const auto &block : blocks)
+    if (pid < 0 || static_cast<size_t>(pid) >= pageTableIndex.size())
+        return;
+
+    PageTableRange &range = pageTableIndex[pid];
+    for (int page = 0; page < range.numPages; ++page)
     {
-        if (block.ownerPid == processId)
-            frames += block.numFrames;
+        PageTableEntry &entry = pageTablePool[range.base + page];
+        if (entry.valid && frameOwners[entry.frameNumber] == packOwner(pid, page))
+        {
+            frameOwners[entry.frameNumber] = kNoOwner;
+        }
+        entry = {-1, false, false};
+        backingStore.erase(pid, page);
     }
-    return frames;
+    range = {-1, 0};
 }
 
-void MemoryManager::mergeFreeBlocks()
+bool MemoryManager::allocate(int processId, int bytes)
 {
-    if (blocks.empty())
-    {
+    std::lock_guard<std::mutex> lock(mtx);
+    int neededFrames = (bytes + frameBytes - 1) / frameBytes;
+
+    int start = findFreeBlock(neededFrames);
+    if (start == -1)
+        return false; // no suitable block
+
+    // Split block if needed; the remainder goes back on its free list
+    int blockFrames = blocks[start].numFrames;
+    removeFreeBlock(start, blockFrames);
+    blocks[start] = {start, neededFrames, processId};
+    addFreeBlock(start + neededFrames, blockFrames - neededFrames);
+    nextFitRover = start + neededFrames;
+
+    if (static_cast<size_t>(processId) >= pageTableIndex.size())
+        pageTableIndex.resize(processId + 1, {-1, 0});
+    pageTableIndex[processId] = {start, neededFrames};
+    std::fill(pageTablePool.begin() + start, pageTablePool.begin() + start + neededFrames,
+              PageTableEntry{-1, false, false});
+
+    numPagedIn += neededFrames;
+    processesInMemory++;
+    layoutVersion++;
+
+    return true;
+}
+
+void MemoryManager::free(int processId)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    if (processId < 0 || static_cast<size_t>(processId) >= pageTableIndex.size() ||
+        pageTableIndex[processId].numPages == 0)
         return;
-    }
 
-    std::vector<Block> merged;
-    merged.push_back(blocks[0]);
+    int start = pageTableIndex[processId].base;
+    int frames = pageTableIndex[processId].numPages;
+    blocks.erase(start);
 
-    for (size_t i = 1; i < blocks.size(); ++i)
+    // Coalesce with free neighbours
+    auto next = blocks.lower_bound(start);
+    if (next != blocks.end() && next->second.ownerPid == -1 && next->first == start + frames)
     {
-        if (merged.back().ownerPid == -1 && blocks[i].ownerPid == -1 &&
-            merged.back().startFrame + merged.back().numFrames == blocks[i].startFrame)
-        {
-            merged.back().numFrames += blocks[i].numFrames;
-        }
-        else
+        int nextFrames = next->second.numFrames;
+        removeFreeBlock(next->first, nextFrames);
+        frames += nextFrames;
+    }
+    auto prev = blocks.lower_bound(start);
+    if (prev != blocks.begin())
+    {
+        --prev;
+        if (prev->second.ownerPid == -1 && prev->first + prev->second.numFrames == start)
         {
-            merged.push_back(blocks[i]);
+            int prevStart = prev->first;
+            int prevFrames = prev->second.numFrames;
+            removeFreeBlock(prevStart, prevFrames);
+            start = prevStart;
+            frames += prevFrames;
         }
     }
+    addFreeBlock(start, frames);
 
-    blocks = std::move(merged);
+    numPagedOut += pageTableIndex[processId].numPages;
+    resetPageTable(processId);
+    processesInMemory--;
+    layoutVersion++;
 }
 
-bool MemoryManager::hasEnoughMemory(int processId, int bytes) const
+int MemoryManager::getFramesPerProcess(int processId) const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (processId < 0 || static_cast<size_t>(processId) >= pageTableIndex.size())
+        return 0;
+    return pageTableIndex[processId].numPages;
+}
+
+bool MemoryManager::hasEnoughMemory(int, int bytes) const
 {
     std::lock_guard<std::mutex> lock(mtx);
     int neededFrames = (bytes + frameBytes - 1) / frameBytes;
-    for (const auto &block : blocks)
-    {
-        if (block.ownerPid == -1 && block.numFrames >= neededFrames)
-        {
-            return true;
-        }
-    }
-    return false;
+    return findFreeBlock(neededFrames) != -1;
 }
 
 bool MemoryManager::isAllocated(int processId) const
 {
     std::lock_guard<std::mutex> lock(mtx);
-    for (const auto &block : blocks)
-    {
-        if (block.ownerPid == processId)
-        {
-            return true;
-        }
-    }
-    return false;
+    return processId >= 0 && static_cast<size_t>(processId) < pageTableIndex.size() &&
+           pageTableIndex[processId].numPages > 0;
 }
 
 int MemoryManager::getFrameSize() const
@@ -151,7 +246,38 @@ int MemoryManager::getFrameSize() const
 std::vector<MemoryManager::Block> MemoryManager::getBlocksSnapshot() const
 {
     std::lock_guard<std::mutex> lock(mtx);
-    return blocks;
+    std::vector<Block> snapshot;
+    snapshot.reserve(blocks.size());
+    for (const auto &entry : blocks)
+        snapshot.push_back(entry.second);
+    return snapshot;
+}
+
+int MemoryManager::getExternalFragmentation(int minBytes) const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    // Classes that lie wholly below minBytes count in full; only the class
+    // straddling it is walked
+    int fragmentedBytes = 0;
+    for (size_t k = 0; k < freeLists.size(); ++k)
+    {
+        long long smallest = (1LL << k) * frameBytes;
+        long long largest = ((1LL << (k + 1)) - 1) * frameBytes;
+        if (smallest >= minBytes)
+            break;
+        if (largest < minBytes)
+        {
+            fragmentedBytes += freeFramesByClass[k] * frameBytes;
+            continue;
+        }
+        for (const auto &hole : freeLists[k].bySize)
+        {
+            if (hole.first * frameBytes >= minBytes)
+                break;
+            fragmentedBytes += hole.first * frameBytes;
+        }
+    }
+    return fragmentedBytes;
 }
 
 bool MemoryManager::isValidAddress(uint32_t address) const
@@ -167,13 +293,15 @@ uint16_t MemoryManager::readUint16(int pid, uint32_t vaddr)
     int pageNum = vaddr / pageSize;
     int offset = vaddr % pageSize;
 
-    if (pageTables[pid].size() <= (size_t)pageNum || !pageTables[pid][pageNum].valid)
+    PageTableEntry &entry = pageTableEntry(pid, pageNum);
+    if (!entry.valid)
     {
+        if (deferPageFaults)
+            throw PageFault(pid, pageNum);
         handlePageFault(pid, pageNum);
     }
-    int frame = pageTables[pid][pageNum].frameNumber;
-    uint32_t physAddr = frame * pageSize + offset;
-    return memory[physAddr];
+    uint32_t physAddr = entry.frameNumber * pageSize + offset;
+    return memory[physAddr / 2];
 }
 
 void MemoryManager::writeUint16(int pid, uint32_t vaddr, uint16_t value)
@@ -184,154 +312,114 @@ void MemoryManager::writeUint16(int pid, uint32_t vaddr, uint16_t value)
     int pageNum = vaddr / pageSize;
     int offset = vaddr % pageSize;
 
-    if (pageTables[pid].size() <= (size_t)pageNum || !pageTables[pid][pageNum].valid)
+    PageTableEntry &entry = pageTableEntry(pid, pageNum);
+    if (!entry.valid)
     {
+        if (deferPageFaults)
+            throw PageFault(pid, pageNum);
         handlePageFault(pid, pageNum);
     }
-    int frame = pageTables[pid][pageNum].frameNumber;
-    uint32_t physAddr = frame * pageSize + offset;
-    memory[physAddr] = value;
-    pageTables[pid][pageNum].dirty = true;
+    uint32_t physAddr = entry.frameNumber * pageSize + offset;
+    memory[physAddr / 2] = value;
+    entry.dirty = true;
 }
 
 void MemoryManager::handlePageFault(int pid, int pageNum)
 {
     int pageSize = frameBytes;
     int freeFrame = -1;
+    const PageTableRange &range = pageTableIndex[pid];
 
-    for (auto &block : blocks)
+    for (int frame = range.base; frame < range.base + range.numPages; ++frame)
     {
-        if (block.ownerPid == pid)
+        if (frameOwners[frame] == kNoOwner)
         {
-            for (int frame = block.startFrame; frame < block.startFrame + block.numFrames; ++frame)
-            {
-                bool frameInUse = false;
-                if (pageTables.find(pid) != pageTables.end())
-                {
-                    for (const auto &entry : pageTables[pid])
-                    {
-                        if (entry.valid && entry.frameNumber == frame)
-                        {
-                            frameInUse = true;
-                            break;
-                        }
-                    }
-                }
-                if (!frameInUse)
-                {
-                    freeFrame = frame;
-                    break;
-                }
-            }
-            if (freeFrame != -1)
-                break;
+            freeFrame = frame;
+            break;
         }
     }
 
-    if (freeFrame == -1)
+    while (freeFrame == -1)
     {
         if (frameQueue.empty())
+            throw std::runtime_error("No frames available for process " + std::to_string(pid));
+
+        int victimFrame = frameQueue.front();
+        frameQueue.pop_front();
+
+        uint64_t owner = frameOwners[victimFrame];
+        if (owner == kNoOwner)
         {
-            for (auto &block : blocks)
-            {
-                if (block.ownerPid == pid)
-                {
-                    freeFrame = block.startFrame;
-                    break;
-                }
-            }
-            if (freeFrame == -1)
-                throw std::runtime_error("No frames available for process " + std::to_string(pid));
+            // Stale entry left behind by a freed process; the frame is already unmapped.
+            freeFrame = victimFrame;
+            break;
         }
-        else
-        {
-            int victimFrame = frameQueue.front();
-            frameQueue.pop_front();
 
-            if (frameToPidPage.find(victimFrame) != frameToPidPage.end())
-            {
-                int victimPidPage = frameToPidPage[victimFrame];
-                int victimPid = victimPidPage >> 16;
-                int victimPage = victimPidPage & 0xFFFF;
-
-                if (pageTables.find(victimPid) != pageTables.end() &&
-                    victimPage < pageTables[victimPid].size() &&
-                    pageTables[victimPid][victimPage].dirty)
-                {
-                    std::vector<uint8_t> pageData(pageSize);
-                    for (int i = 0; i < pageSize; i += 2)
-                    {
-                        uint32_t addr = victimFrame * pageSize + i;
-                        if (memory.find(addr) != memory.end())
-                        {
-                            pageData[i] = memory[addr] & 0xFF;
-                            pageData[i + 1] = (memory[addr] >> 8) & 0xFF;
-                        }
-                    }
-                    backingStore[{victimPid, victimPage}] = pageData;
-                }
-
-                if (pageTables.find(victimPid) != pageTables.end() &&
-                    victimPage < pageTables[victimPid].size())
-                {
-                    pageTables[victimPid][victimPage].valid = false;
-                }
-                numPagedOut++;
-            }
+        int victimPid = ownerPid(owner);
+        int victimPage = ownerPage(owner);
+        PageTableEntry &victimEntry = pageTablePool[pageTableIndex[victimPid].base + victimPage];
 
-            freeFrame = victimFrame;
+        if (victimEntry.dirty)
+        {
+            backingStore.store(victimPid, victimPage, &memory[victimFrame * pageSize / 2]);
         }
-    }
 
-    std::vector<uint8_t> pageData(pageSize, 0);
-    auto it = backingStore.find({pid, pageNum});
-    if (it != backingStore.end())
-    {
-        pageData = it->second;
-        backingStore.erase(it);
+        victimEntry.valid = false;
+        victimEntry.dirty = false;
+        frameOwners[victimFrame] = kNoOwner;
+        numPagedOut++;
+
+        freeFrame = victimFrame;
     }
 
-    for (int i = 0; i < pageSize; i += 2)
+    uint16_t *frameWords = &memory[freeFrame * pageSize / 2];
+    if (!backingStore.load(pid, pageNum, frameWords))
     {
-        uint32_t addr = freeFrame * pageSize + i;
-        memory[addr] = pageData[i] | (pageData[i + 1] << 8);
+        std::fill(frameWords, frameWords + (pageSize + 1) / 2, 0);
     }
 
-    if (pageTables[pid].size() <= (size_t)pageNum)
-        pageTables[pid].resize(pageNum + 1, {-1, false, false});
-
-    pageTables[pid][pageNum].frameNumber = freeFrame;
-    pageTables[pid][pageNum].valid = true;
-    pageTables[pid][pageNum].dirty = false;
+    PageTableEntry &entry = pageTablePool[range.base + pageNum];
+    entry.frameNumber = freeFrame;
+    entry.valid = true;
+    entry.dirty = false;
 
     frameQueue.push_back(freeFrame);
-    frameToPidPage[freeFrame] = (pid << 16) | pageNum;
+    frameOwners[freeFrame] = packOwner(pid, pageNum);
     numPagedIn++;
 }
 
-void MemoryManager::saveProcessToBackingStore(int pid)
+void MemoryManager::servicePageFault(int pid, int pageNum)
 {
     std::lock_guard<std::mutex> lock(mtx);
+    PageTableEntry &entry = pageTableEntry(pid, pageNum);
+    if (!entry.valid)
+    {
+        handlePageFault(pid, pageNum);
+    }
+}
 
-    if (pageTables.find(pid) == pageTables.end())
-        return;
-
-    for (size_t pageNum = 0; pageNum < pageTables[pid].size(); ++pageNum)
+void MemoryManager::saveProcessToBackingStore(int pid)
+{
     {
-        auto &entry = pageTables[pid][pageNum];
-        if (entry.valid && entry.dirty)
+        std::lock_guard<std::mutex> lock(mtx);
+
+        if (pid < 0 || static_cast<size_t>(pid) >= pageTableIndex.size())
+            return;
+
+        const PageTableRange &range = pageTableIndex[pid];
+        for (int pageNum = 0; pageNum < range.numPages; ++pageNum)
         {
-            std::vector<uint8_t> pageData(frameBytes);
-            for (int i = 0; i < frameBytes; i += 2)
+            auto &entry = pageTablePool[range.base + pageNum];
+            if (entry.valid && entry.dirty)
             {
-                uint32_t addr = entry.frameNumber * frameBytes + i;
-                pageData[i] = memory[addr] & 0xFF;
-                pageData[i + 1] = (memory[addr] >> 8) & 0xFF;
+                backingStore.store(pid, pageNum, &memory[entry.frameNumber * frameBytes / 2]);
+                numPagedOut++;
             }
-            backingStore[{pid, static_cast<int>(pageNum)}] = pageData;
-            numPagedOut++;
+            if (entry.valid)
+                frameOwners[entry.frameNumber] = kNoOwner;
+            entry.valid = false;
+            entry.dirty = false;
         }
-        entry.valid = false;
     }
     writeBackingStoreToFile("csopesy-backing-store.txt");
 }
@@ -340,22 +428,12 @@ void MemoryManager::evictProcess(int pid)
 {
     saveProcessToBackingStore(pid);
 
+    // Frames unmapped above have no owner left; drop them from the FIFO.
+    std::lock_guard<std::mutex> lock(mtx);
     auto it = std::remove_if(frameQueue.begin(), frameQueue.end(),
-                             [this, pid](int frame)
-                             {
-                                 auto mapIt = frameToPidPage.find(frame);
-                                 return mapIt != frameToPidPage.end() &&
-                                        (mapIt->second >> 16) == pid;
-                             });
+                             [this](int frame)
+                             { return frameOwners[frame] == kNoOwner; });
     frameQueue.erase(it, frameQueue.end());
-
-    for (auto it = frameToPidPage.begin(); it != frameToPidPage.end();)
-    {
-        if ((it->second >> 16) == pid)
-            it = frameToPidPage.erase(it);
-        else
-            ++it;
-    }
 }
 
 void MemoryManager::writeBackingStoreToFile(const std::string& filename) const
@@ -364,18 +442,20 @@ void MemoryManager::writeBackingStoreToFile(const std::string& filename) const
     std::ofstream out(filename);
     if (!out) return;
 
-    for (const auto& entry : backingStore)
-    {
-        int pid = entry.first.first;
-        int pageNum = entry.first.second;
-        const std::vector<uint8_t>& pageData = entry.second;
-
+    backingStore.forEachPage([&](int pid, int pageNum, const std::vector<uint16_t> &words)
+                             {
         out << pid << " " << pageNum << " ";
-        for (uint8_t byte : pageData)
+        for (int i = 0; i < frameBytes; ++i)
         {
-            out << static_cast<int>(byte) << " ";
+            uint16_t word = words[i / 2];
+            out << static_cast<int>(i % 2 == 0 ? word & 0xFF : (word >> 8) & 0xFF) << " ";
         }
-        out << "\n";
-    }
+        out << "\n"; });
     out.close();
-}
\ No newline at end of file
+}
+
+BackingStore::Stats MemoryManager::getSwapStats() const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return backingStore.getStats();
+}
@@ -3,8 +3,16 @@
 #include <utility>
 #include <mutex>
 #include <unordered_map>
+#include <map>
+#include <set>
 #include <deque>
 #include <fstream>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <atomic>
+#include "BackingStore.h"
+#include "Config.h"
 struct PageTableEntry
 {
     int frameNumber;
@@ -12,15 +20,24 @@ struct PageTableEntry
     bool dirty;
 };
 
-struct pair_hash
+// Where a process's page table lives inside the flat page table pool.
+// numPages == 0 means the process has no memory admitted.
+struct PageTableRange
 {
-    template <class T1, class T2>
-    std::size_t operator()(const std::pair<T1, T2> &p) const
-    {
-        auto h1 = std::hash<T1>{}(p.first);
-        auto h2 = std::hash<T2>{}(p.second);
-        return h1 ^ h2;
-    }
+    int base;
+    int numPages;
+};
+
+// Thrown by readUint16/writeUint16 when deferred page faults are enabled and
+// the page is not resident. Nothing has been read or written at that point,
+// so the instruction can simply be retried once the pager has loaded it.
+struct PageFault : std::runtime_error
+{
+    int pid;
+    int pageNum;
+    PageFault(int pid, int pageNum)
+        : std::runtime_error("Page fault: process " + std::to_string(pid) + " page " + std::to_string(pageNum)),
+          pid(pid), pageNum(pageNum) {}
 };
 
 class MemoryManager
@@ -33,38 +50,84 @@ public:
         int ownerPid; // -1 if free
     };
 
-    MemoryManager(int totalBytes, int frameBytes);
+    MemoryManager(int totalBytes, int frameBytes, PlacementPolicy policy = PlacementPolicy::FirstFit);
     bool allocate(int processId, int bytes); // returns true if successful
     void free(int processId);
-    int getTotalFreeMemory() const;
+    // Running aggregates, readable from any thread without taking the lock
+    int getTotalFreeMemory() const { return freeFrames.load(std::memory_order_relaxed) * frameBytes; }
+    int getUsedMemory() const { return totalBytes - getTotalFreeMemory(); }
+    int getProcessesInMemory() const { return processesInMemory.load(std::memory_order_relaxed); }
     int getFramesPerProcess(int processId) const;
     bool hasEnoughMemory(int processId, int bytes) const;
     bool isAllocated(int processId) const;
     int getFrameSize() const;
     std::vector<Block> getBlocksSnapshot() const;
+    int getExternalFragmentation(int minBytes) const; // free bytes in holes smaller than minBytes
+    PlacementPolicy getPlacementPolicy() const { return placementPolicy; }
+    uint64_t getLayoutVersion() const { return layoutVersion.load(); } // bumped on every allocate/free
     bool isValidAddress(uint32_t address) const;
     uint16_t readUint16(int pid, uint32_t vaddr);
     void writeUint16(int pid, uint32_t vaddr, uint16_t value);
-    int getNumPagedIn() const { return numPagedIn; }
-    int getNumPagedOut() const { return numPagedOut; }
+    int getNumPagedIn() const { return numPagedIn.load(std::memory_order_relaxed); }
+    int getNumPagedOut() const { return numPagedOut.load(std::memory_order_relaxed); }
     void handlePageFault(int pid, int pageNum);
+    void servicePageFault(int pid, int pageNum); // locked entry point for the pager
+    void setDeferPageFaults(bool defer) { deferPageFaults = defer; }
     void saveProcessToBackingStore(int pid);
     void loadProcessFromBackingStore(int pid);
     void evictProcess(int pid);
     void writeBackingStoreToFile(const std::string& filename) const;
+    BackingStore::Stats getSwapStats() const;
 
 private:
     int totalBytes;
     int frameBytes;
     int totalFrames;
-    std::vector<Block> blocks; // contiguous blocks, some free, some allocated
-    mutable std::mutex mtx;    // Mutex for thread-safe access, now mutable
-    void mergeFreeBlocks();
-    std::unordered_map<uint32_t, uint16_t> memory;
-	int numPagedIn = 0;
-	int numPagedOut = 0;
-    std::unordered_map<int, std::vector<PageTableEntry>> pageTables;
-    std::unordered_map<std::pair<int, int>, std::vector<uint8_t>, pair_hash> backingStore;
+    std::map<int, Block> blocks; // keyed by startFrame, some free, some allocated
+    mutable std::mutex mtx;      // Mutex for thread-safe access, now mutable
+    std::atomic<int> freeFrames{0};
+    std::atomic<int> processesInMemory{0};
+    std::atomic<uint64_t> layoutVersion{0};
+
+    // Segregated free lists: class k holds free blocks of [2^k, 2^(k+1)) frames,
+    // indexed both by address (first/next fit) and by size (best/worst fit).
+    struct FreeList
+    {
+        std::map<int, int> byAddress;           // startFrame -> numFrames
+        std::set<std::pair<int, int>> bySize;   // (numFrames, startFrame)
+    };
+    std::vector<FreeList> freeLists;
+    std::vector<int> freeFramesByClass; // total frames on each free list
+    PlacementPolicy placementPolicy;
+    int nextFitRover = 0;
+    static int sizeClassOf(int frames);
+    void addFreeBlock(int startFrame, int numFrames);
+    void removeFreeBlock(int startFrame, int numFrames);
+    int findFreeBlock(int neededFrames) const; // startFrame, or -1
+    int firstFitFrom(int neededFrames, int fromFrame) const;
+    std::vector<uint16_t> memory; // physical memory, one word per even byte address
+	std::atomic<int> numPagedIn{0};
+	std::atomic<int> numPagedOut{0};
+    bool deferPageFaults = false;
+
+    // Page tables are sized once at admission. A process owns exactly as many
+    // pages as frames in its block, so its table is stored in the pool at the
+    // block's start frame and the pool never needs more than totalFrames entries.
+    std::vector<PageTableEntry> pageTablePool;
+    std::vector<PageTableRange> pageTableIndex; // indexed by pid
+    PageTableEntry &pageTableEntry(int pid, int pageNum);
+    void resetPageTable(int pid);
+
+    BackingStore backingStore;
     std::deque<int> frameQueue;
-    std::unordered_map<int, int> frameToPidPage;
+
+    // Reverse map indexed by frame: (pid << 32) | page, or kNoOwner.
+    static constexpr uint64_t kNoOwner = ~0ULL;
+    std::vector<uint64_t> frameOwners;
+    static uint64_t packOwner(int pid, int pageNum)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(pid)) << 32) | static_cast<uint32_t>(pageNum);
+    }
+    static int ownerPid(uint64_t owner) { return static_cast<int>(owner >> 32); }
+    static int ownerPage(uint64_t owner) { return static_cast<int>(owner & 0xFFFFFFFFu); }
 };
\ No newline at end of file
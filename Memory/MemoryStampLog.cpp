@@ -0,0 +1,235 @@
+#include "MemoryStampLog.h"
+#include "CoarseClock.h"
+#include <algorithm>
+#include <map>
+#include <sstream>
+
+namespace
+{
+    const char kMagic[4] = {'M', 'S', 'L', '1'};
+
+    template <typename T>
+    void writeRaw(std::ofstream &out, T value)
+    {
+        out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    template <typename T>
+    bool readRaw(std::ifstream &in, T &value)
+    {
+        return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(value)));
+    }
+
+    bool sameBlock(const MemoryManager::Block &a, const MemoryManager::Block &b)
+    {
+        return a.startFrame == b.startFrame && a.numFrames == b.numFrames && a.ownerPid == b.ownerPid;
+    }
+}
+
+std::string formatMemoryStamp(const MemoryStamp &stamp, int frameSize, int minMemPerProc)
+{
+    std::string timebuf = CoarseClock::format(stamp.timestamp, "%m/%d/%Y %I:%M:%S%p");
+
+    const auto &blocks = stamp.blocks;
+    int procCount = 0;
+    int extFrag = 0;
+    for (const auto &block : blocks)
+    {
+        if (block.ownerPid != -1)
+            procCount++;
+        else if (block.numFrames * frameSize < minMemPerProc)
+            extFrag += block.numFrames * frameSize;
+    }
+
+    std::ostringstream out;
+    out << "Timestamp: (" << timebuf << ")\n";
+    out << "Number of processes in memory: " << procCount << "\n";
+    out << "Total external fragmentation in KB: " << (extFrag / 1024) << "\n\n";
+
+    int upper = 0;
+    if (!blocks.empty() && frameSize > 0)
+    {
+        const auto &lastBlock = blocks.back();
+        upper = lastBlock.startFrame * frameSize + lastBlock.numFrames * frameSize;
+    }
+    out << "----end---- = " << upper << "\n";
+
+    for (auto it = blocks.rbegin(); it != blocks.rend(); ++it)
+    {
+        const auto &block = *it;
+        out << (block.startFrame * frameSize + block.numFrames * frameSize) << "\n";
+        if (block.ownerPid == -1)
+            out << "FREE\n";
+        else
+            out << "P" << block.ownerPid << "\n";
+        out << (block.startFrame * frameSize) << "\n\n";
+    }
+    out << "----start---- = 0\n";
+    return out.str();
+}
+
+MemoryStampWriter::MemoryStampWriter(const std::string &path, int frameSize, int minMemPerProc)
+    : path(path), frameSize(frameSize), minMemPerProc(minMemPerProc)
+{
+}
+
+MemoryStampWriter::~MemoryStampWriter()
+{
+    stop();
+}
+
+void MemoryStampWriter::start(const std::function<void(std::thread &)> &place)
+{
+    if (running)
+        return;
+
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        return;
+    out.write(kMagic, sizeof(kMagic));
+    writeRaw<int32_t>(out, frameSize);
+    writeRaw<int32_t>(out, minMemPerProc);
+    lastBlocks.clear();
+
+    running = true;
+    writerThread = std::thread(&MemoryStampWriter::writerThreadFunc, this);
+    if (place)
+        place(writerThread);
+}
+
+void MemoryStampWriter::stop()
+{
+    if (!running)
+        return;
+    running = false;
+    queueCv.notify_all();
+    if (writerThread.joinable())
+        writerThread.join();
+    out.close();
+}
+
+void MemoryStampWriter::record(int cycle, std::vector<MemoryManager::Block> blocks, bool unchanged)
+{
+    if (!running)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queue.push_back({cycle, CoarseClock::now(), unchanged, std::move(blocks)});
+    }
+    queueCv.notify_one();
+}
+
+void MemoryStampWriter::writerThreadFunc()
+{
+    std::deque<Pending> batch;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCv.wait(lock, [this]
+                         { return !queue.empty() || !running; });
+            if (queue.empty() && !running)
+                break;
+            batch.swap(queue);
+        }
+
+        for (const auto &stamp : batch)
+            writeDelta(stamp);
+        batch.clear();
+        out.flush();
+    }
+}
+
+void MemoryStampWriter::writeDelta(const Pending &stamp)
+{
+    std::vector<int32_t> removed;
+    std::vector<MemoryManager::Block> upserts;
+
+    if (!stamp.unchanged)
+    {
+        // Both layouts are address ordered, so a single merge pass finds the delta
+        size_t i = 0, j = 0;
+        const auto &current = stamp.blocks;
+        while (i < lastBlocks.size() || j < current.size())
+        {
+            if (j == current.size() || (i < lastBlocks.size() && lastBlocks[i].startFrame < current[j].startFrame))
+            {
+                removed.push_back(lastBlocks[i++].startFrame);
+            }
+            else if (i == lastBlocks.size() || current[j].startFrame < lastBlocks[i].startFrame)
+            {
+                upserts.push_back(current[j++]);
+            }
+            else
+            {
+                if (!sameBlock(lastBlocks[i], current[j]))
+                    upserts.push_back(current[j]);
+                ++i;
+                ++j;
+            }
+        }
+        lastBlocks = current;
+    }
+
+    writeRaw<uint32_t>(out, static_cast<uint32_t>(stamp.cycle));
+    writeRaw<int64_t>(out, static_cast<int64_t>(stamp.timestamp));
+    writeRaw<uint32_t>(out, static_cast<uint32_t>(removed.size()));
+    writeRaw<uint32_t>(out, static_cast<uint32_t>(upserts.size()));
+    for (int32_t start : removed)
+        writeRaw<int32_t>(out, start);
+    for (const auto &block : upserts)
+    {
+        writeRaw<int32_t>(out, block.startFrame);
+        writeRaw<int32_t>(out, block.numFrames);
+        writeRaw<int32_t>(out, block.ownerPid);
+    }
+}
+
+MemoryStampReader::MemoryStampReader(const std::string &path)
+    : in(path, std::ios::binary)
+{
+    char magic[sizeof(kMagic)];
+    int32_t headerFrameSize = 0, headerMinMem = 0;
+    if (in.read(magic, sizeof(magic)) && std::equal(magic, magic + sizeof(magic), kMagic) &&
+        readRaw(in, headerFrameSize) && readRaw(in, headerMinMem))
+    {
+        frameSize = headerFrameSize;
+        minMemPerProc = headerMinMem;
+        valid = true;
+    }
+}
+
+bool MemoryStampReader::next(MemoryStamp &stamp)
+{
+    uint32_t cycle, numRemoved, numUpserts;
+    int64_t timestamp;
+    if (!valid || !readRaw(in, cycle) || !readRaw(in, timestamp) ||
+        !readRaw(in, numRemoved) || !readRaw(in, numUpserts))
+        return false;
+
+    std::map<int, MemoryManager::Block> layout;
+    for (const auto &block : stamp.blocks)
+        layout[block.startFrame] = block;
+
+    for (uint32_t i = 0; i < numRemoved; ++i)
+    {
+        int32_t start;
+        if (!readRaw(in, start))
+            return false;
+        layout.erase(start);
+    }
+    for (uint32_t i = 0; i < numUpserts; ++i)
+    {
+        int32_t start, frames, owner;
+        if (!readRaw(in, start) || !readRaw(in, frames) || !readRaw(in, owner))
+            return false;
+        layout[start] = {start, frames, owner};
+    }
+
+    stamp.cycle = static_cast<int>(cycle);
+    stamp.timestamp = static_cast<std::time_t>(timestamp);
+    stamp.blocks.clear();
+    for (const auto &entry : layout)
+        stamp.blocks.push_back(entry.second);
+    return true;
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include "MemoryManager.h"
+
+// Memory stamps are kept as one append-only binary log of delta records
+// instead of one text file per cycle. Each record holds the cycle, a
+// timestamp and the blocks removed/added since the previous record; the
+// memstamp-dump tool replays the log to regenerate memory_stamp_<cycle>.txt.
+//
+// File layout (host byte order):
+//   header: "MSL1", int32 frameSize, int32 minMemPerProc
+//   record: uint32 cycle, int64 timestamp, uint32 numRemoved, uint32 numUpserts,
+//           numRemoved x int32 startFrame,
+//           numUpserts x (int32 startFrame, int32 numFrames, int32 ownerPid)
+
+struct MemoryStamp
+{
+    int cycle;
+    std::time_t timestamp;
+    std::vector<MemoryManager::Block> blocks; // full layout, address ordered
+};
+
+// Renders a stamp in the memory_stamp_<cycle>.txt format.
+std::string formatMemoryStamp(const MemoryStamp &stamp, int frameSize, int minMemPerProc);
+
+class MemoryStampWriter
+{
+public:
+    MemoryStampWriter(const std::string &path, int frameSize, int minMemPerProc);
+    ~MemoryStampWriter();
+
+    // place, if given, is called with the writer thread once it exists
+    void start(const std::function<void(std::thread &)> &place = {});
+    void stop();
+
+    // Called from the scheduler; only queues the stamp. An empty layout with
+    // unchanged = true records the cycle without copying any blocks.
+    void record(int cycle, std::vector<MemoryManager::Block> blocks, bool unchanged);
+
+private:
+    struct Pending
+    {
+        int cycle;
+        std::time_t timestamp;
+        bool unchanged;
+        std::vector<MemoryManager::Block> blocks;
+    };
+
+    std::string path;
+    int frameSize;
+    int minMemPerProc;
+    std::ofstream out;
+    std::vector<MemoryManager::Block> lastBlocks;
+
+    std::thread writerThread;
+    std::mutex queueMutex;
+    std::condition_variable queueCv;
+    std::deque<Pending> queue;
+    std::atomic<bool> running{false};
+
+    void writerThreadFunc();
+    void writeDelta(const Pending &stamp);
+};
+
+class MemoryStampReader
+{
+public:
+    explicit MemoryStampReader(const std::string &path);
+    bool isOpen() const { return in.is_open() && valid; }
+    int getFrameSize() const { return frameSize; }
+    int getMinMemPerProc() const { return minMemPerProc; }
+
+    // Applies the next delta record; false at end of log.
+    bool next(MemoryStamp &stamp);
+
+private:
+    std::ifstream in;
+    bool valid = false;
+    int frameSize = 0;
+    int minMemPerProc = 0;
+};
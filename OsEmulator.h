@@ -4,6 +4,8 @@
 #include <cstdlib>
 #include "process_list.h"
 #include "console.h"
+#include "console_sink.h"
+#include "CoarseClock.h"
 #include "scheduler.h"
 #include "MemoryManager.h"
 #include "PrintCommand.h"
@@ -29,6 +31,10 @@ using std::string;
 
 ProcessList processes;
 
+// screen -ls only prints this many of the most recent finished processes;
+// report-util writes all of them
+const size_t kScreenFinishedRows = 50;
+
 // Function to parse a single instruction
 std::shared_ptr<Command> parseInstruction(const std::string &instruction)
 {
@@ -164,8 +170,80 @@ void printHeader()
     cout << RESET;
 }
 
+// Optional per-process flags accepted after screen -s / screen -c
+struct ScreenOptions
+{
+    int priority = 0;
+    int tickets = 0; // 0: default-tickets
+    string group = "default";
+    int deadline = 0; // ticks, 0: none
+    int pinnedCore = -1;
+};
+
+// Parses "--flag value" pairs; prints the offending flag and returns false on error
+bool parseScreenOptions(const string &flags, const Config &config, ScreenOptions &options)
+{
+    int numCores = config.getNumCPU();
+    std::istringstream in(flags);
+    string flag;
+    string value;
+    while (in >> flag >> value)
+    {
+        try
+        {
+            if (flag == "--priority")
+            {
+                options.priority = std::stoi(value);
+                if (options.priority < 0 || options.priority > 31)
+                    throw std::out_of_range("priority");
+            }
+            else if (flag == "--tickets")
+            {
+                options.tickets = std::stoi(value);
+                if (options.tickets < 1 || options.tickets > 10000)
+                    throw std::out_of_range("tickets");
+            }
+            else if (flag == "--group")
+            {
+                options.group = value;
+            }
+            else if (flag == "--deadline")
+            {
+                options.deadline = std::stoi(value);
+                if (options.deadline < 1)
+                    throw std::out_of_range("deadline");
+            }
+            else if (flag == "--pin")
+            {
+                // Only the FIFO queues honour hard pinning
+                SchedulerAlgorithm algorithm = config.getSchedulerAlgorithm();
+                if (algorithm != SchedulerAlgorithm::FCFS && algorithm != SchedulerAlgorithm::RR)
+                {
+                    cout << "--pin requires the fcfs or rr scheduler (current: "
+                         << schedulerAlgorithmName(algorithm) << ")." << endl;
+                    return false;
+                }
+                options.pinnedCore = std::stoi(value);
+                if (options.pinnedCore < 0 || options.pinnedCore >= numCores)
+                    throw std::out_of_range("pin");
+            }
+            else
+            {
+                cout << "Unknown screen option '" << flag << "'." << endl;
+                return false;
+            }
+        }
+        catch (const std::exception &)
+        {
+            cout << "Invalid value '" << value << "' for " << flag << "." << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
 // Create or resume screen
-void createOrResumeScreen(const string &cmd, const string &name, int memSize, Scheduler &scheduler)
+void createOrResumeScreen(const string &cmd, const string &name, int memSize, Scheduler &scheduler, const ScreenOptions &options = {})
 {
     if (cmd == "screen -s")
     { // Create new process
@@ -175,24 +253,20 @@ void createOrResumeScreen(const string &cmd, const string &name, int memSize, Sc
         }
         else
         {
-            processes.addNewProcess(-1, 0, name);
-            int pid = processes.findProcessByName(name);
-
-            if (pid == -1)
-            {
-                cout << "Failed to create process." << endl;
-                return;
-            }
+            int pid = processes.addNewProcess(-1, options.priority, name).pid();
 
             processes.withProcessByRef(pid, [&](process &proc)
                                        {
                 proc.setMemorySize(memSize);
-                proc.setMemoryManager(&scheduler.getMemoryManager()); });
+                proc.setMemoryManager(&scheduler.getMemoryManager());
+                proc.setTickets(options.tickets);
+                proc.setGroup(options.group);
+                proc.setDeadline(options.deadline);
+                proc.setPinnedCore(options.pinnedCore); });
 
             try
             {
-                process &procRef = processes.findProcessByRef(pid);
-                scheduler.addProcess(procRef);
+                scheduler.addProcess(*processes.findProcess(pid));
                 cout << "Process '" << name << "' created and added to scheduler with " << memSize << " bytes of memory." << endl;
             }
             catch (const std::exception &e)
@@ -207,8 +281,7 @@ void createOrResumeScreen(const string &cmd, const string &name, int memSize, Sc
         if (processes.ifProcessNameExists(name))
         {
             int pid = processes.findProcessByName(name);
-            process curr_proc = processes.findProcess(pid);
-            console proc_console(processes, curr_proc);
+            console proc_console(processes, pid);
             proc_console.handleScreen();
             printHeader();
         }
@@ -221,7 +294,7 @@ void createOrResumeScreen(const string &cmd, const string &name, int memSize, Sc
 
 // Create process with custom instructions
 // Update function signature to accept Scheduler&
-void createProcessWithInstructions(const string &processName, int memorySize, const string &instructions, Scheduler &scheduler)
+void createProcessWithInstructions(const string &processName, int memorySize, const string &instructions, Scheduler &scheduler, const ScreenOptions &options = {})
 {
     if (processes.ifProcessNameExists(processName))
     {
@@ -242,14 +315,7 @@ void createProcessWithInstructions(const string &processName, int memorySize, co
         }
 
         // Create process
-        processes.addNewProcess(-1, 0, processName);
-        int pid = processes.findProcessByName(processName);
-
-        if (pid == -1)
-        {
-            cout << "Failed to create process." << endl;
-            return;
-        }
+        int pid = processes.addNewProcess(-1, options.priority, processName).pid();
 
         if (!scheduler.getMemoryManager().allocate(pid, memorySize))
         {
@@ -265,12 +331,25 @@ void createProcessWithInstructions(const string &processName, int memorySize, co
             proc.clearInstructions();
             proc.setMemoryManager(&scheduler.getMemoryManager()); 
             proc.setMemorySize(memorySize);
+            proc.setTickets(options.tickets);
+            proc.setGroup(options.group);
+            proc.setDeadline(options.deadline);
+            proc.setPinnedCore(options.pinnedCore);
             for (const auto& cmd : commands) {
                 proc.addInstruction(cmd);
             } });
 
         // Add process to scheduler's ready queue
-        scheduler.addProcess(processes.findProcess(pid));
+        try
+        {
+            scheduler.addProcess(*processes.findProcess(pid));
+        }
+        catch (const AdmissionRejected &)
+        {
+            scheduler.getMemoryManager().free(pid);
+            processes.removeProcess(pid);
+            throw;
+        }
 
         cout << "Process '" << processName << "' created with " << commands.size() << " instructions." << endl;
     }
@@ -285,7 +364,7 @@ void listScreens()
     processes.printAllProcesses();
 }
 
-void generateReport(const Config &config, bool toConsole = true)
+void generateReport(const Config &config, Scheduler &scheduler, bool toConsole = true)
 {
     int totalCores = config.getNumCPU();
     int usedCores = 0;
@@ -294,16 +373,7 @@ void generateReport(const Config &config, bool toConsole = true)
 
     // Header
     output << "CPU utilization: ";
-    int runningCount = 0;
-
-    for (const auto &pair : processes.getAll())
-    {
-        const process &proc = pair.second;
-        if (proc.getState() == ProcessState::RUNNING)
-            runningCount++;
-    }
-
-    usedCores = runningCount;
+    usedCores = scheduler.getBusyCores();
     int utilization = (100 * usedCores) / totalCores;
     output << utilization << "%\n";
     output << "Cores used: " << usedCores << "\n";
@@ -311,33 +381,41 @@ void generateReport(const Config &config, bool toConsole = true)
     output << "------------------------------------\n";
 
     output << "Running processes:\n";
-    for (const auto &pair : processes.getAll())
-    {
-        const process &proc = pair.second;
-        if (proc.getState() == ProcessState::RUNNING)
+    processes.forEachInState(ProcessState::RUNNING, 0, [&](const ProcessInfo &info, const ProcessStatus &status)
+                             {
+        if (status.state == ProcessState::RUNNING)
         {
             output << std::left << std::setw(15)
-                   << proc.getProcessName()
-                   << std::setw(25) << proc.getCreationTime()
-                   << "Core: " << proc.getCoreId()
-                   << " " << proc.getCurrentLine()
-                   << " / " << proc.getLineCount() << "\n";
+                   << info.name
+                   << std::setw(25) << CoarseClock::format(info.creationTime)
+                   << "Core: " << status.coreId
+                   << " " << status.currentLine
+                   << " / " << status.totalLines;
+            if (!toConsole)
+                output << "  Migrations: " << status.migrations;
+            output << "\n";
         }
-    }
+    });
 
+    int finishedCount = processes.countInState(ProcessState::FINISHED);
+    size_t finishedRows = toConsole ? kScreenFinishedRows : 0;
     output << "\nFinished processes:\n";
-    for (const auto &pair : processes.getAll())
-    {
-        const process &proc = pair.second;
-        if (proc.getState() == ProcessState::FINISHED)
+    if (finishedRows != 0 && finishedCount > static_cast<int>(finishedRows))
+        output << "(latest " << finishedRows << " of " << finishedCount << ", see report-util for all)\n";
+    processes.forEachInState(ProcessState::FINISHED, finishedRows, [&](const ProcessInfo &info, const ProcessStatus &status)
+                             {
+        if (status.state == ProcessState::FINISHED)
         {
             output << std::left << std::setw(15)
-                   << proc.getProcessName()
-                   << std::setw(25) << proc.getCreationTime()
+                   << info.name
+                   << std::setw(25) << CoarseClock::format(info.creationTime)
                    << "Finished "
-                   << proc.getLineCount() << " / " << proc.getLineCount() << "\n";
+                   << status.totalLines << " / " << status.totalLines;
+            if (!toConsole)
+                output << "  Migrations: " << status.migrations;
+            output << "\n";
         }
-    }
+    });
 
     if (toConsole)
     {
@@ -366,26 +444,11 @@ void generateMemReport(const Config &config, Scheduler &scheduler)
     int usedCores = 0;
 
     int totalMem = config.getMaxOverallMem();
-    int usedMem = 0;
+    int usedMem = scheduler.getMemoryManager().getUsedMemory();
 
     std::ostringstream output;
-    int runningCount = 0;
 
-    for (const auto &pair : processes.getAll())
-    {
-        const process &proc = pair.second;
-        if (proc.getState() == ProcessState::RUNNING)
-            runningCount++;
-
-        if (scheduler.getMemoryManager().isAllocated(proc.getPid()))
-        {
-            int memUsed = scheduler.getMemoryManager().getFramesPerProcess(proc.getPid()) *
-                          scheduler.getMemoryManager().getFrameSize();
-            usedMem += memUsed;
-        }
-    }
-
-    usedCores = runningCount;
+    usedCores = scheduler.getBusyCores();
     int utilization = (100 * usedCores) / totalCores;
     output << "CPU-Util: " << utilization << "%\n";
     output << "Memory Usage: " << usedMem << " / " << totalMem << " MiB\n";
@@ -395,21 +458,18 @@ void generateMemReport(const Config &config, Scheduler &scheduler)
     output << "Running processes and memory usage:\n";
     output << "----------------------------------------------------------------------\n";
 
-    for (const auto &pair : processes.getAll())
-    {
-        const process &proc = pair.second;
-        if (proc.getState() == ProcessState::RUNNING)
+    processes.forEachInState(ProcessState::RUNNING, 0, [&](const ProcessInfo &info, const ProcessStatus &status)
+                             {
+        if (status.state == ProcessState::RUNNING)
         {
-            MemoryManager *memMgr = proc.getMemoryManager();
-            int memUsed = 0;
-            if (memMgr)
-                memUsed = memMgr->getFramesPerProcess(proc.getPid()) * memMgr->getFrameSize();
+            MemoryManager &memMgr = scheduler.getMemoryManager();
+            int memUsed = memMgr.getFramesPerProcess(info.pid) * memMgr.getFrameSize();
             if (memUsed >= 1024)
-                output << proc.getProcessName() << " " << (memUsed / 1024) << "KiB\n";
+                output << info.name << " " << (memUsed / 1024) << "KiB\n";
             else
-                output << proc.getProcessName() << " " << memUsed << "MiB\n";
+                output << info.name << " " << memUsed << "MiB\n";
         }
-    }
+    });
     output << "----------------------------------------------------------------------\n";
     std::cout << output.str();
 }
@@ -422,47 +482,101 @@ void vmstat(const Config &config, Scheduler &scheduler)
     int totalMem = config.getMaxOverallMem();
     int usedMem = totalMem - memoryManager.getTotalFreeMemory();
     int freeMem = memoryManager.getTotalFreeMemory();
+    int extFrag = memoryManager.getExternalFragmentation(config.getMinMemPerProc());
 
     // CPU tick stats (you need to implement these counters in Scheduler)
-    int idleCpuTicks = scheduler.getIdleTicks();     // implement this
-    int activeCpuTicks = scheduler.getActiveTicks(); // implement this
-    int totalCpuTicks = idleCpuTicks + activeCpuTicks;
+    uint64_t idleCpuTicks = scheduler.getIdleTicks();
+    uint64_t activeCpuTicks = scheduler.getActiveTicks();
+    uint64_t totalCpuTicks = idleCpuTicks + activeCpuTicks;
 
     // Paging stats (implement these in MemoryManager if needed)
     int numPagedIn = memoryManager.getNumPagedIn();   // implement this
     int numPagedOut = memoryManager.getNumPagedOut(); // implement this
 
+    BackingStore::Stats swap = memoryManager.getSwapStats();
+    double swapRatio = swap.storedBytes > 0 ? static_cast<double>(swap.rawBytes) / swap.storedBytes : 0.0;
+    long long avgCompressNs = swap.compressions > 0 ? swap.compressNanos / swap.compressions : 0;
+    long long avgDecompressNs = swap.decompressions > 0 ? swap.decompressNanos / swap.decompressions : 0;
+
     std::cout << "------------------- VMSTAT -------------------\n";
     std::cout << "Total memory: " << totalMem << " bytes\n";
     std::cout << "Used memory: " << usedMem << " bytes\n";
     std::cout << "Free memory: " << freeMem << " bytes\n";
+    std::cout << "Placement policy: " << placementPolicyName(memoryManager.getPlacementPolicy()) << "\n";
+    std::cout << "External fragmentation: " << extFrag << " bytes\n";
     std::cout << "Idle cpu ticks: " << idleCpuTicks << "\n";
     std::cout << "Active cpu ticks: " << activeCpuTicks << "\n";
     std::cout << "Total cpu ticks: " << totalCpuTicks << "\n";
+    uint64_t contextSwitches = scheduler.getContextSwitches();
+    double avgSlice = contextSwitches > 0 ? static_cast<double>(scheduler.getDispatchedInstructions()) / contextSwitches : 0.0;
+    std::cout << "Context switches: " << contextSwitches << "\n";
+    std::cout << "Avg slice length: " << std::fixed << std::setprecision(2) << avgSlice << std::defaultfloat << " instructions\n";
+    std::cout << "Core migrations: " << scheduler.getMigrations() << "\n";
     std::cout << "Num paged in: " << numPagedIn << "\n";
     std::cout << "Num paged out: " << numPagedOut << "\n";
+    std::cout << "Swapped pages: " << swap.pagesStored << " (" << swap.zeroPages << " zero)\n";
+    std::cout << "Swap footprint: " << swap.storedBytes << " / " << swap.rawBytes << " bytes";
+    if (swap.storedBytes > 0)
+        std::cout << " (" << std::fixed << std::setprecision(1) << swapRatio << std::defaultfloat << "x)";
+    std::cout << "\n";
+    std::cout << "Avg compress time: " << avgCompressNs << " ns\n";
+    std::cout << "Avg decompress time: " << avgDecompressNs << " ns\n";
+    Scheduler::TurnaroundStats turnaround = scheduler.getTurnaroundStats();
+    std::cout << "Finished processes: " << turnaround.finished << ", mean turnaround "
+              << std::fixed << std::setprecision(2) << turnaround.meanMs << std::defaultfloat << " ms\n";
+    if (config.getSchedulerAlgorithm() == SchedulerAlgorithm::EDF)
+    {
+        ReadyDeadlineStats deadlines = scheduler.getReadyDeadlineStats();
+        std::cout << "Deadlines met: " << deadlines.met << ", missed: " << deadlines.missed
+                  << ", rejected: " << deadlines.rejected << ", pending: " << deadlines.pending << "\n";
+    }
+    std::vector<ReadyGroupStats> groups = scheduler.getReadyGroupStats();
+    uint64_t groupTicks = 0;
+    for (const ReadyGroupStats &group : groups)
+        groupTicks += group.ticks;
+    for (const ReadyGroupStats &group : groups)
+    {
+        double share = groupTicks > 0 ? 100.0 * group.ticks / groupTicks : 0.0;
+        std::cout << "Group " << group.name << " (" << group.tickets << " tickets): " << group.ticks
+                  << " ticks (" << std::fixed << std::setprecision(1) << share << std::defaultfloat << "%), "
+                  << group.depth << " waiting\n";
+    }
+    for (const ReadyLevelStats &level : scheduler.getReadyLevelStats())
+    {
+        std::cout << "Ready level " << level.level << " (quantum " << level.quantum << "): "
+                  << level.depth << " waiting, " << level.dispatched << " dispatched, avg wait "
+                  << std::fixed << std::setprecision(2) << level.avgWaitMs << std::defaultfloat << " ms\n";
+    }
     std::cout << "----------------------------------------------\n";
 }
 
 void startEmulator(Config &config)
 {
     string command;
-    regex pattern(R"(^screen -([rs])(?:\s+([^\s]+))(?:\s+(\d+))?\s*$)");
-    regex customPattern(R"REG(^screen -c\s+(\S+)(?:\s+(\d+))?\s+"(.*)"\s*$)REG");
+    regex pattern(R"(^screen -([rs])(?:\s+([^\s]+))(?:\s+(\d+))?((?:\s+--[a-z-]+\s+\S+)*)\s*$)");
+    regex customPattern(R"REG(^screen -c\s+(\S+)(?:\s+(\d+))?((?:\s+--[a-z-]+\s+\S+)*)\s+"(.*)"\s*$)REG");
 
 
     smatch match;
-    MemoryManager memoryManager(config.getMaxOverallMem(), config.getMemPerFrame());
+    processes.setLogCapacity(config.getLogCapacity());
+    MemoryManager memoryManager(config.getMaxOverallMem(), config.getMemPerFrame(), config.getPlacementPolicy());
     Scheduler scheduler(processes, config, memoryManager);
 
+    auto housekeeping = [&scheduler](std::thread &thread)
+    { scheduler.pinHousekeeping(thread); };
+    CoarseClock::start(housekeeping);
+    consoleSink().start(housekeeping);
+    processTrace().start("csopesy-trace.bin", housekeeping);
     scheduler.start();
 
     clearScreen();
     printHeader();
 
     cout << "Scheduler initialized with " << config.getNumCPU() << " cores and "
-         << (config.getSchedulerAlgorithm() == SchedulerAlgorithm::FCFS ? "FCFS" : "Round Robin")
+         << schedulerAlgorithmName(config.getSchedulerAlgorithm())
          << " algorithm." << endl;
+    if (scheduler.getPlacement().pinsWorkers() || !config.getHousekeepingCpus().empty())
+        cout << "Host placement: " << scheduler.getPlacement().describe() << "." << endl;
 
     while (true)
     {
@@ -480,12 +594,12 @@ void startEmulator(Config &config)
         }
         else if (command == "screen -ls")
         {
-            generateReport(config, true);
+            generateReport(config, scheduler, true);
             //listScreens();
         }
         else if (command == "report-util")
         {
-            generateReport(config, false); // file
+            generateReport(config, scheduler, false); // file
         }
         else if (command == "process-smi")
         {
@@ -504,6 +618,9 @@ void startEmulator(Config &config)
         {
             cout << "Exit command recognized. Exiting program." << endl;
             scheduler.stop();
+            processTrace().stop();
+            consoleSink().stop();
+            CoarseClock::stop();
             break;
         }
         // Handle screen -c command for custom instructions
@@ -511,9 +628,11 @@ void startEmulator(Config &config)
         {
             string processName = match[1];
             int memorySize = match[2].matched ? std::stoi(match[2]) : config.getMinMemPerProc();
-            string instructions = match[3];
+            string instructions = match[4];
+            ScreenOptions options;
 
-            createProcessWithInstructions(processName, memorySize, instructions, scheduler);
+            if (parseScreenOptions(match[3], config, options))
+                createProcessWithInstructions(processName, memorySize, instructions, scheduler, options);
 
 
         }
@@ -549,6 +668,7 @@ void startEmulator(Config &config)
                     else
                     {
                         int memSize = stoi(match[3]);
+                        ScreenOptions options;
 
                         auto isPowerOfTwo = [](int n)
                         {
@@ -559,9 +679,9 @@ void startEmulator(Config &config)
                         {
                             cout << "Invalid memory allocation. Size must be a power of 2 between 64 and 65536." << endl;
                         }
-                        else
+                        else if (parseScreenOptions(match[4], config, options))
                         {
-                            createOrResumeScreen("screen -s", name, memSize, scheduler);
+                            createOrResumeScreen("screen -s", name, memSize, scheduler, options);
                         }
                     }
                 }
@@ -574,6 +694,12 @@ void startEmulator(Config &config)
             cout << "  screen -r <name>     : Resume existing process" << endl;
             cout << "  screen -c <name> <mem> \"<instructions>\" : Create process with custom instructions" << endl;
             cout << "  screen -ls           : List all processes" << endl;
+            cout << "Options for -s and -c (after <mem>):" << endl;
+            cout << "  --priority <0-31>    : Priority under the prio scheduler (higher runs first)" << endl;
+            cout << "  --tickets <1-10000>  : CPU share under the stride scheduler" << endl;
+            cout << "  --group <name>       : Share group (tenant) under the stride scheduler" << endl;
+            cout << "  --deadline <ticks>   : Completion deadline under the edf scheduler" << endl;
+            cout << "  --pin <core>         : Run only on this core (fcfs/rr)" << endl;
         }
         else
         {
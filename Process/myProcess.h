@@ -12,100 +12,127 @@
 #include "Command.h"
 #include "ForCommand.h"
 #include <MemoryManager.h>
+#include "process_status.h"
+#include "process_state_index.h"
+#include "process_log.h"
+#include "process_trace.h"
+#include "CoarseClock.h"
 
-enum class ProcessState
-{
-	READY,
-	RUNNING,
-	WAITING,
-	FINISHED
-};
-
-inline std::string getCurrentTimeString()
-{
-	auto now = std::chrono::system_clock::now();
-	std::time_t createdTime = std::chrono::system_clock::to_time_t(now);
-
-	std::ostringstream oss;
-	oss << std::put_time(std::localtime(&createdTime), "%m/%d/%Y %H:%M:%S");
-	return oss.str();
-}
-
+// Cold, mostly immutable metadata of a process. The state a worker updates
+// every tick lives in the ProcessHotState this object points at, which
+// ProcessList keeps in a separate pid-indexed array. The object only exists
+// while the process can still run; see ProcessList::archiveProcess.
 class process
 {
 private:
 	int pid;
-	int coreId;
-	int priority;
-	ProcessState state;
-	std::string processName;
+	ProcessHotState *hot;
+	const ProcessInfo *info;
+	ProcessStateIndex *stateIndex;
 	std::vector<std::shared_ptr<Command>> instructions;
-	int currentLine = 0;
-	std::string creationTime;
-	std::vector<std::string> logs; // for print command
-	bool isSleeping = false;
-	uint8_t sleepTime = 0; // in milliseconds for sleep state
+	ProcessLog logs;
 	MemoryManager *memoryManager = nullptr;
 	int memorySize = 0;
+	int tickets = 0;                // share under the stride scheduler; 0 uses default-tickets
+	std::string group = "default"; // share group (tenant) under the stride scheduler
+	int deadline = 0;               // ticks from creation under EDF; 0: none
+	int pinnedCore = -1;            // hard affinity under fcfs/rr; -1: any core
+	int traceSlot = -1;             // trace buffer holding this process's latest records
+
+	void recountLines()
+	{
+		int count = 0;
+		for (const auto &cmd : instructions)
+			count += getCommandLineCount(cmd);
+		hot->set(hot->totalLines, count);
+	}
 
 public:
-	std::unordered_map<std::string, uint16_t> variables;
+	std::unordered_map<std::string, uint16_t> &variables;
 	// Constructor
-	process(int pid, int coreId, int priority, const std::string &processName,
+	process(int pid, int coreId, int priority, const ProcessInfo &info,
 			const std::vector<std::shared_ptr<Command>> &instructions,
-			MemoryManager *memMgr)
-		: pid(pid), coreId(coreId), priority(priority), processName(processName),
-		  instructions(instructions), memoryManager(memMgr)
+			MemoryManager *memMgr, ProcessHotState &hotState, ProcessStateIndex &stateIndex,
+			size_t logCapacity)
+		: pid(pid), hot(&hotState), info(&info), stateIndex(&stateIndex),
+		  instructions(instructions), logs(logCapacity), memoryManager(memMgr), variables(hotState.variables)
 	{
-		creationTime = getCurrentTimeString();
-		state = ProcessState::READY;
+		hot->pid = pid;
+		hot->priority = priority;
+		hot->set(hot->coreId, coreId);
+		hot->set(hot->state, ProcessState::READY);
+		recountLines();
 	}
 
-	process() : pid(0), coreId(-1), priority(0), processName(""), memoryManager(nullptr)
+	// Processes are owned by ProcessList and never copied
+	process(const process &) = delete;
+	process &operator=(const process &) = delete;
+
+	// Runs when the last pin is dropped; the hot state outlives the object,
+	// so hand its variables' memory back here
+	~process()
 	{
-		creationTime = getCurrentTimeString();
-		state = ProcessState::READY;
+		std::unordered_map<std::string, uint16_t>().swap(variables);
+	}
+
+	ProcessStatus getStatus() const
+	{
+		return hot->read();
 	}
 
 	// methods
-	void addLog(const std::stringstream &log)
+	// Stamps the record with the time, line and core, then appends it to the
+	// ring and the run's trace file. No text is built here; see formatLogRecord.
+	void addLog(LogRecord &record)
 	{
-		logs.emplace_back(log.str());
+		record.timestamp = CoarseClock::now();
+		record.line = getCurrentLine();
+		record.coreId = static_cast<int16_t>(getCoreId());
+		logs.append(record);
+		processTrace().append(pid, info->name, traceSlot, record, record.source->logTemplate(record));
 	}
-	void printLogs() const
+	std::string formatLogs() const
 	{
-		for (const auto &log : logs)
-		{
-			std::cout << log;
-		}
+		return logs.format();
+	}
+	bool hasLogs() const
+	{
+		return !logs.empty();
 	}
 
 	// Getters and setters
 	MemoryManager *getMemoryManager() const { return memoryManager; }
 	void setMemorySize(int size) { memorySize = size; }
 	int getMemorySize() const { return memorySize; }
+	void setTickets(int count) { tickets = count; }
+	int getTickets() const { return tickets; }
+	void setGroup(const std::string &name) { group = name; }
+	const std::string &getGroup() const { return group; }
+	void setDeadline(int ticks) { deadline = ticks; }
+	int getDeadline() const { return deadline; }
+	void setPinnedCore(int core) { pinnedCore = core; }
+	int getPinnedCore() const { return pinnedCore; }
 
 	void setMemoryManager(MemoryManager *mgr)
 	{
 		memoryManager = mgr;
 	}
 
-	const std::vector<std::string> &getLogs() const
+	void setSleeping(bool sleeping)
 	{
-		return logs;
+		hot->sleeping = sleeping;
 	}
-
-	void setSleeping(bool sleeping)
+	bool isSleeping() const
 	{
-		isSleeping = sleeping;
+		return hot->sleeping;
 	}
 	uint8_t getSleepTime() const
 	{
-		return sleepTime;
+		return hot->sleepTime;
 	}
 	void setSleepTime(uint8_t time)
 	{
-		sleepTime = time;
+		hot->sleepTime = time;
 	}
 	int getPid() const
 	{
@@ -113,25 +140,24 @@ public:
 	}
 	int getPriority() const
 	{
-		return priority;
+		return hot->priority;
 	}
 	const std::string &getProcessName() const
 	{
-		return processName;
+		return info->name;
 	}
 	void setState(ProcessState newState)
 	{
-		// std::cout << "[DIAG] setState called for PID " << pid << " from " << static_cast<int>(state) << " to " << static_cast<int>(newState) << std::endl;
-		state = newState;
+		stateIndex->transition(*hot, newState);
 	}
 	ProcessState getState() const
 	{
-		return state;
+		return hot->state.load(std::memory_order_relaxed);
 	}
 
 	void setPriority(int newPriority)
 	{
-		priority = newPriority;
+		hot->priority = newPriority;
 	}
 
 	const std::vector<std::shared_ptr<Command>> &getInstructions() const
@@ -142,11 +168,13 @@ public:
 	void clearInstructions()
 	{
 		instructions.clear();
+		hot->set(hot->totalLines, 0);
 	}
 
 	void setInstructions(const std::vector<std::shared_ptr<Command>> &instr)
 	{
 		instructions = instr;
+		recountLines();
 	}
 
 	int getInstructionCount() const
@@ -156,17 +184,12 @@ public:
 
 	void incrementCurrentLine()
 	{
-		currentLine++;
+		hot->set(hot->currentLine, getCurrentLine() + 1);
 	}
 
 	int getLineCount() const
 	{
-		int count = 0;
-		for (const auto &cmd : instructions)
-		{
-			count += getCommandLineCount(cmd);
-		}
-		return count;
+		return hot->totalLines.load(std::memory_order_relaxed);
 	}
 
 	int getCommandLineCount(const std::shared_ptr<Command> &cmd) const
@@ -186,70 +209,60 @@ public:
 
 	int getCurrentLine() const
 	{
-		return currentLine;
+		return hot->currentLine.load(std::memory_order_relaxed);
 	}
 
-	void setCoreId(int id)
-	{
-		coreId = id;
+	// Called by the worker that dispatches the process on coreId. The core,
+	// migration count and RUNNING state are published together. Returns
+	// whether the process last ran on another core.
+	bool dispatch(int coreId)
+	{
+		int lastCore = getCoreId();
+		bool migrated = lastCore != -1 && lastCore != coreId;
+		stateIndex->transition(*hot, ProcessState::RUNNING, [&]
+							   {
+			hot->coreId.store(coreId, std::memory_order_relaxed);
+			if (migrated)
+				hot->migrations.store(hot->migrations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); });
+		return migrated;
 	}
 
 	int getCoreId() const
 	{
-		return coreId;
+		return hot->coreId.load(std::memory_order_relaxed);
 	}
 
 	void setCurrentLine(int line)
 	{
-		currentLine = line;
+		hot->set(hot->currentLine, line);
 	}
 
-	std::string getCreationTime() const
+	std::time_t getCreationTime() const
 	{
-		return creationTime;
+		return info->creationTime;
 	}
 
 	void addInstruction(const std::shared_ptr<Command> &command)
 	{
 		instructions.push_back(command);
+		hot->set(hot->totalLines, getLineCount() + getCommandLineCount(command));
 	}
 
 	bool isComplete() const
 	{
-		return currentLine >= instructions.size();
+		return getCurrentLine() >= instructions.size();
 	}
 
-	// util functions
-	void printProcessInfo() const
-	{
-		std::string coreIdStr = (coreId < 0) ? "N/A" : std::to_string(coreId);
-
-		if (state == ProcessState::FINISHED)
-		{
-			std::cout << std::left << std::setw(15)
-					  << processName << std::setw(25)
-					  << creationTime << std::setw(13)
-					  << "Finished" << "Line: "
-					  << currentLine << "/" << getLineCount() << "\n";
-		}
-		else
-		{
-			std::cout << std::left << std::setw(15)
-					  << processName << std::setw(25)
-					  << creationTime << std::setw(8)
-					  << "Core: " << std::setw(5)
-					  << coreIdStr << "Line: "
-					  << currentLine << "/" << getLineCount() << "\n";
-		}
-	}
 	std::shared_ptr<Command> getCurrentInstruction() const
 	{
-		if (currentLine < instructions.size())
-			return instructions[currentLine];
+		int line = getCurrentLine();
+		if (line < instructions.size())
+			return instructions[line];
 		return nullptr;
 	}
 	void insertInstructions(int pos, const std::vector<std::shared_ptr<Command>> &cmds)
 	{
 		instructions.insert(instructions.begin() + pos, cmds.begin(), cmds.end());
+		recountLines();
 	}
 };
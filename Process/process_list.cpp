@@ -1,19 +1,79 @@
 #include "process_list.h"
 
-process ProcessList::findProcess(int pid)
+static void printProcessInfo(const ProcessInfo &info, const ProcessStatus &status)
 {
-	std::lock_guard<std::mutex> lock(mtx);
-	auto it = processMap.find(pid);
-	if (it != processMap.end())
+	std::string coreIdStr = (status.coreId < 0) ? "N/A" : std::to_string(status.coreId);
+
+	if (status.state == ProcessState::FINISHED)
 	{
-		return it->second;
+		std::cout << std::left << std::setw(15)
+				  << info.name << std::setw(25)
+				  << CoarseClock::format(info.creationTime) << std::setw(13)
+				  << "Finished" << "Line: "
+				  << status.currentLine << "/" << status.totalLines << "\n";
 	}
 	else
 	{
-		return process(-1, -1, -1, "Unknown", {}, nullptr); // Return an invalid process if not found
+		std::cout << std::left << std::setw(15)
+				  << info.name << std::setw(25)
+				  << CoarseClock::format(info.creationTime) << std::setw(8)
+				  << "Core: " << std::setw(5)
+				  << coreIdStr << "Line: "
+				  << status.currentLine << "/" << status.totalLines << "\n";
 	}
 }
 
+ProcessList::~ProcessList()
+{
+	for (auto &segment : segments)
+	{
+		delete[] segment.load();
+	}
+	for (auto *hotSegment : hotSegments)
+	{
+		delete[] hotSegment;
+	}
+}
+
+ProcessList::Slot *ProcessList::findSlot(int pid) const
+{
+	if (pid <= 0 || pid >= kSegmentSize * kMaxSegments)
+		return nullptr;
+
+	Slot *segment = segments[pid >> kSegmentBits].load(std::memory_order_acquire);
+	if (!segment)
+		return nullptr;
+
+	Slot &slot = segment[pid & (kSegmentSize - 1)];
+	if ((slot.generation.load(std::memory_order_acquire) & 1) == 0)
+		return nullptr;
+	return &slot;
+}
+
+ProcessHandle ProcessList::getHandle(int pid) const
+{
+	Slot *slot = findSlot(pid);
+	if (!slot)
+		return {};
+	return {static_cast<uint32_t>(pid), slot->generation.load(std::memory_order_acquire)};
+}
+
+std::shared_ptr<process> ProcessList::get(ProcessHandle handle) const
+{
+	Slot *slot = findSlot(handle.pid());
+	if (!slot || slot->generation.load(std::memory_order_acquire) != handle.generation)
+		return nullptr;
+	return slot->proc.load(std::memory_order_acquire);
+}
+
+bool ProcessList::getStatus(int pid, ProcessStatus &status) const
+{
+	if (!findSlot(pid))
+		return false;
+	status = hotState(pid).read();
+	return true;
+}
+
 bool ProcessList::ifProcessNameExists(const std::string &processName)
 {
 	std::lock_guard<std::mutex> lock(mtx);
@@ -34,21 +94,17 @@ int ProcessList::findProcessByName(const std::string &processName)
 	}
 }
 
-process &ProcessList::findProcessByRef(int pid)
+std::shared_ptr<process> ProcessList::findProcess(int pid)
 {
-	std::lock_guard<std::mutex> lock(mtx);
-	auto it = processMap.find(pid);
-	if (it != processMap.end())
-	{
-		return it->second;
-	}
-	else
+	std::shared_ptr<process> proc = pin(pid);
+	if (!proc)
 	{
 		throw std::runtime_error("Process not found");
 	}
+	return proc;
 }
 
-void ProcessList::addNewProcess(int coreId, int priority, const std::string &processName)
+ProcessHandle ProcessList::addNewProcess(int coreId, int priority, const std::string &processName)
 {
 	std::lock_guard<std::mutex> lock(mtx);
 
@@ -57,55 +113,132 @@ void ProcessList::addNewProcess(int coreId, int priority, const std::string &pro
 		throw std::runtime_error("Process name already exists!");
 	}
 
-	int newPid = getNextAvailablePid();
-	process newProc(newPid, coreId, priority, processName, {}, nullptr);
+	int newPid = lastPid.load() + 1;
+	if (newPid >= kSegmentSize * kMaxSegments)
+	{
+		throw std::runtime_error("Process table is full!");
+	}
 
-	newProc.setState(ProcessState::READY);
+	auto &segmentPtr = segments[newPid >> kSegmentBits];
+	Slot *segment = segmentPtr.load(std::memory_order_relaxed);
+	if (!segment)
+	{
+		hotSegments[newPid >> kSegmentBits] = new ProcessHotState[kSegmentSize];
+		segment = new Slot[kSegmentSize];
+		segmentPtr.store(segment, std::memory_order_release);
+	}
+
+	// Build the process in place, then publish it by making the generation odd
+	Slot &slot = segment[newPid & (kSegmentSize - 1)];
+	slot.info = ProcessInfo{};
+	slot.info.pid = newPid;
+	slot.info.name = processName;
+	slot.info.creationTime = CoarseClock::now();
+	slot.proc.store(std::make_shared<process>(newPid, coreId, priority, slot.info,
+											  std::vector<std::shared_ptr<Command>>{}, nullptr, hotState(newPid), stateIndex,
+											  logCapacity),
+					std::memory_order_relaxed);
+	stateIndex.insert(hotState(newPid));
+	uint32_t generation = slot.generation.fetch_add(1, std::memory_order_release) + 1;
 
-	processMap[newPid] = newProc;
 	nameToPidMap[processName] = newPid;
+	lastPid.store(getNextAvailablePid(), std::memory_order_release);
+	return {static_cast<uint32_t>(newPid), generation};
 }
 
-void ProcessList::updateProcess(const process &proc)
+// Holders of a pin (findProcess, withProcessByRef, a handle's get) keep the
+// object alive; it is freed when the last of them lets go, outside mtx
+void ProcessList::removeProcess(int pid)
 {
-	std::lock_guard<std::mutex> lock(mtx);
-	int pid = proc.getPid();
-	auto it = processMap.find(pid);
-	if (it != processMap.end())
+	std::shared_ptr<process> removed;
 	{
-		it->second = proc;
+		std::lock_guard<std::mutex> lock(mtx);
+
+		Slot *slot = findSlot(pid);
+		if (!slot)
+			return;
+
+		nameToPidMap.erase(slot->info.name);
+		stateIndex.remove(hotState(pid));
+		slot->generation.fetch_add(1, std::memory_order_release);
+		removed = slot->proc.exchange(nullptr, std::memory_order_acq_rel);
 	}
 }
 
-void ProcessList::removeProcess(int pid)
+void ProcessList::archiveProcess(int pid)
 {
 	std::lock_guard<std::mutex> lock(mtx);
 
-	auto it = processMap.find(pid);
-	processMap.erase(pid);
+	Slot *slot = findSlot(pid);
+	if (!slot)
+		return;
+	// Unpublish first: new lookups miss, and readers that already pinned
+	// the process keep it (and its variables) alive until they finish
+	std::shared_ptr<process> proc = slot->proc.exchange(nullptr, std::memory_order_acq_rel);
+	if (!proc)
+		return;
 
-	for (auto it = nameToPidMap.begin(); it != nameToPidMap.end();)
+	std::string text = proc->formatLogs();
+	if (!text.empty())
 	{
-		if (it->second == pid)
+		if (!archiveLog.is_open())
 		{
-			it = nameToPidMap.erase(it);
-		}
-		else
-		{
-			++it;
+			archiveLog.open(kArchiveLogPath, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+			if (!archiveLog)
+				throw std::runtime_error("Failed to open archive log");
 		}
+		archiveLog.seekp(archiveLogSize);
+		archiveLog.write(text.data(), text.size());
+		slot->info.logOffset = archiveLogSize;
+		slot->info.logBytes = static_cast<uint32_t>(text.size());
+		archiveLogSize += text.size();
+	}
+	slot->info.finishTime = CoarseClock::now();
+}
+
+bool ProcessList::getInfo(int pid, ProcessInfo &info) const
+{
+	std::lock_guard<std::mutex> lock(mtx);
+
+	Slot *slot = findSlot(pid);
+	if (!slot)
+		return false;
+	info = slot->info;
+	return true;
+}
+
+std::string ProcessList::readLogs(int pid) const
+{
+	std::lock_guard<std::mutex> lock(mtx);
+
+	Slot *slot = findSlot(pid);
+	if (!slot)
+		return {};
+
+	std::string text;
+	if (std::shared_ptr<process> proc = slot->proc.load(std::memory_order_acquire))
+	{
+		text = proc->formatLogs();
+	}
+	else if (slot->info.logOffset >= 0)
+	{
+		text.resize(slot->info.logBytes);
+		archiveLog.seekg(slot->info.logOffset);
+		archiveLog.read(text.data(), text.size());
+		text.resize(archiveLog.gcount());
+		archiveLog.clear();
 	}
+	return text;
 }
 
 int ProcessList::getNextAvailablePid()
 {
-	return ++lastPid;
+	return lastPid.load() + 1;
 }
 
 void ProcessList::printAllProcesses()
 {
-	std::lock_guard<std::mutex> lock(mtx);
-	if (processMap.empty())
+	if (lastPid.load() == 0)
 	{
 		std::cout << "No processes found." << std::endl;
 		return;
@@ -113,15 +246,13 @@ void ProcessList::printAllProcesses()
 
 	std::cout << "-----------------------------------\nRunning processes:\n";
 	int runningCount = 0;
-	for (const auto &pair : processMap)
-	{
-		const process &proc = pair.second;
-		if (proc.getState() == ProcessState::RUNNING)
+	forEachInState(ProcessState::RUNNING, 0, [&](const ProcessInfo &info, const ProcessStatus &status)
+				   {
+		if (status.state == ProcessState::RUNNING)
 		{
-			proc.printProcessInfo();
+			printProcessInfo(info, status);
 			runningCount++;
-		}
-	}
+		} });
 	if (runningCount == 0)
 		std::cout << "None\n";
 
@@ -155,15 +286,13 @@ void ProcessList::printAllProcesses()
 
 	std::cout << "\nFinished processes:\n";
 	int finishedCount = 0;
-	for (const auto &pair : processMap)
-	{
-		const process &proc = pair.second;
-		if (proc.getState() == ProcessState::FINISHED)
+	forEachInState(ProcessState::FINISHED, 0, [&](const ProcessInfo &info, const ProcessStatus &status)
+				   {
+		if (status.state == ProcessState::FINISHED)
 		{
-			proc.printProcessInfo();
+			printProcessInfo(info, status);
 			finishedCount++;
-		}
-	}
+		} });
 	if (finishedCount == 0)
 		std::cout << "None\n";
 }
\ No newline at end of file
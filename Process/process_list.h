@@ -1,41 +1,151 @@
 #pragma once
 #include "myProcess.h"
+#include "process_state_index.h"
 #include <unordered_map>
 #include <mutex> // Added for mutex
+#include <atomic>
+#include <array>
+#include <memory>
+#include <fstream>
+#include <cstdint>
 
+// Generation-checked reference to a process-table slot. A handle goes stale
+// (get() returns nullptr) once its process is removed.
+struct ProcessHandle
+{
+    uint32_t index = 0;
+    uint32_t generation = 0;
+    int pid() const { return static_cast<int>(index); }
+};
+
+// Processes live in fixed-size segments indexed by pid. Segments are never
+// moved or freed while the list exists, so a process's address is stable and
+// lookups are two loads with no lock. The mutex only serialises creation,
+// removal and the name index.
+//
+// Each segment has a twin array of ProcessHotState, so dispatch and reporting
+// walk cache-line-sized records and never touch the cold process objects.
+//
+// A finished process is archived: its logs are appended to an archive file,
+// the process object (instructions, variables, logs) is unpublished, and only
+// the slot's ProcessInfo and hot status remain. Accessors that hand out the
+// process object pin it with a shared_ptr copy, so a reader racing the
+// archive keeps it alive until it is done; the object is freed by whoever
+// drops the last pin.
 class ProcessList
 {
 private:
-    std::unordered_map<int, process> processMap;
+    static constexpr int kSegmentBits = 12;
+    static constexpr int kSegmentSize = 1 << kSegmentBits;
+    static constexpr int kMaxSegments = 1 << 14; // room for ~67M pids
+
+    struct Slot
+    {
+        std::atomic<uint32_t> generation{0}; // odd while occupied
+        std::atomic<std::shared_ptr<process>> proc; // null once archived
+        ProcessInfo info;
+    };
+
+    static constexpr const char *kArchiveLogPath = "csopesy-archive.log";
+
+    std::array<std::atomic<Slot *>, kMaxSegments> segments{};
+    std::array<ProcessHotState *, kMaxSegments> hotSegments{}; // published along with segments
     std::unordered_map<std::string, int> nameToPidMap;
-    int lastPid = 0;
+    ProcessStateIndex stateIndex;
+    std::atomic<int> lastPid{0};
     mutable std::mutex mtx; // Mutex for thread safety
+    mutable std::fstream archiveLog; // guarded by mtx
+    int64_t archiveLogSize = 0;
+    size_t logCapacity = 100;
+
+    Slot *findSlot(int pid) const;
+    std::shared_ptr<process> pin(int pid) const
+    {
+        Slot *slot = findSlot(pid);
+        return slot ? slot->proc.load(std::memory_order_acquire) : nullptr;
+    }
+    ProcessHotState &hotState(int pid) const
+    {
+        return hotSegments[pid >> kSegmentBits][pid & (kSegmentSize - 1)];
+    }
 
 public:
-    process findProcess(int pid);
-    process &findProcessByRef(int pid);
-    void addNewProcess(int coreId, int priority, const std::string &processName);
-    void updateProcess(const process &proc);
+    ProcessList() = default;
+    ~ProcessList();
+    ProcessList(const ProcessList &) = delete;
+    ProcessList &operator=(const ProcessList &) = delete;
+
+    // Throws if the process does not exist or has been archived
+    std::shared_ptr<process> findProcess(int pid);
+    ProcessHandle addNewProcess(int coreId, int priority, const std::string &processName);
+    bool getStatus(int pid, ProcessStatus &status) const;
     void printAllProcesses();
     int findProcessByName(const std::string &processName);
     bool ifProcessNameExists(const std::string &processName);
     int getNextAvailablePid();
+    // Drops a process that never got admitted (e.g. an admission
+    // rejection): its pid, name and state entry go away at once, and the
+    // object lives on only while someone still pins it
     void removeProcess(int pid);
 
+    // Called by the thread that retired the process, after its last use of it
+    void archiveProcess(int pid);
+    bool getInfo(int pid, ProcessInfo &info) const;
+    std::string readLogs(int pid) const;
+
+    // Applies to processes created afterwards
+    void setLogCapacity(size_t capacity) { logCapacity = capacity; }
+
+    int countInState(ProcessState state) const { return stateIndex.count(state); }
+
+    ProcessHandle getHandle(int pid) const;
+    std::shared_ptr<process> get(ProcessHandle handle) const;
 
     // Safe access to a process by reference using a lambda
     template<typename Func>
     void withProcessByRef(int pid, Func fn) {
-        std::lock_guard<std::mutex> lock(mtx);
-        auto it = processMap.find(pid);
-        if (it != processMap.end()) {
-            fn(it->second);
+        if (std::shared_ptr<process> proc = pin(pid)) {
+            fn(*proc);
+        }
+    }
+
+    // Visits every process that has not been archived in pid order
+    template<typename Func>
+    void forEach(Func fn) const
+    {
+        int last = lastPid.load(std::memory_order_acquire);
+        for (int pid = 1; pid <= last; ++pid)
+        {
+            if (std::shared_ptr<const process> proc = pin(pid))
+                fn(*proc);
         }
     }
 
-    const std::unordered_map<int, process> &getAll() const
+    // Like forEachStatus, but only visits the most recent `limit` (0 = all)
+    // processes that are in `state`, in the order they entered it
+    template<typename Func>
+    void forEachInState(ProcessState state, size_t limit, Func fn) const
     {
-        std::lock_guard<std::mutex> lock(mtx);
-        return processMap;
+        for (int pid : stateIndex.collect(state, limit))
+        {
+            Slot *slot = findSlot(pid);
+            if (slot)
+                fn(static_cast<const ProcessInfo &>(slot->info), hotState(pid).read());
+        }
+    }
+
+    // Reporting path: fn(info, status) gets a consistent status snapshot read
+    // through the seqlock, without blocking the worker running the process.
+    // Covers archived processes too; only info's identity fields may be used.
+    template<typename Func>
+    void forEachStatus(Func fn) const
+    {
+        int last = lastPid.load(std::memory_order_acquire);
+        for (int pid = 1; pid <= last; ++pid)
+        {
+            Slot *slot = findSlot(pid);
+            if (slot)
+                fn(static_cast<const ProcessInfo &>(slot->info), hotState(pid).read());
+        }
     }
 };
@@ -0,0 +1,74 @@
+#include "process_log.h"
+#include "Command.h"
+#include "CoarseClock.h"
+#include <thread>
+
+std::string formatLogRecord(const LogRecord &record, std::string_view logTemplate)
+{
+	std::string text;
+	if (record.op == LogOp::Print)
+	{
+		text += "[Core " + std::to_string(record.coreId) + "] (" + CoarseClock::format(record.timestamp) + "): ";
+	}
+
+	for (size_t i = 0; i < logTemplate.size(); ++i)
+	{
+		if (logTemplate[i] == kOperandMarker && i + 1 < logTemplate.size())
+		{
+			int index = logTemplate[++i] - '0';
+			if (index >= 0 && index < LogRecord::kMaxOperands && !(record.missing & (1 << index)))
+				text += std::to_string(record.operands[index]);
+		}
+		else
+		{
+			text += logTemplate[i];
+		}
+	}
+
+	if (record.op == LogOp::Print)
+		text += "\n";
+	return text;
+}
+
+std::vector<LogRecord> ProcessLog::snapshot(uint64_t &dropped) const
+{
+	std::vector<LogRecord> ordered;
+	ordered.reserve(slots.size());
+	uint64_t count = 0;
+	size_t kept = 0;
+	while (true)
+	{
+		uint64_t before = sequence.load(std::memory_order_acquire);
+		if (before & 1)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		count = total.load(std::memory_order_relaxed);
+		kept = count < slots.size() ? static_cast<size_t>(count) : slots.size();
+		ordered.clear();
+		for (uint64_t i = count - kept; i < count; ++i)
+			ordered.push_back(slots[i % slots.size()].load());
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (sequence.load(std::memory_order_relaxed) == before)
+			break;
+	}
+
+	dropped = count - kept;
+	return ordered;
+}
+
+std::string ProcessLog::format() const
+{
+	uint64_t dropped = 0;
+	std::vector<LogRecord> entries = snapshot(dropped);
+
+	std::string text;
+	if (dropped > 0)
+		text += "(" + std::to_string(dropped) + " earlier log entries dropped)\n";
+	for (const auto &record : entries)
+		text += formatLogRecord(record, record.source->logTemplate(record));
+	return text;
+}
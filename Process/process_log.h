@@ -0,0 +1,114 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+class Command;
+
+enum class LogOp : uint8_t
+{
+	Print,
+	Add,
+	Read,
+	Write,
+	WriteError
+};
+
+// One log entry as captured on the instruction path. It holds values only;
+// the text comes from source->logTemplate() when someone views the log.
+// source stays valid because a process never drops instructions while it
+// can still log (archiving formats the log before freeing them).
+struct LogRecord
+{
+	static constexpr int kMaxOperands = 4;
+
+	std::time_t timestamp = 0;
+	const Command *source = nullptr;
+	int32_t line = 0; // instruction line the entry was logged at
+	int16_t coreId = -1;
+	LogOp op = LogOp::Print;
+	uint8_t missing = 0; // bit i: operands[i] has no value and prints as nothing
+	uint16_t operands[kMaxOperands] = {};
+};
+
+// In a log template, kOperandMarker followed by '0'..'3' stands for that
+// operand of the record. A control character, so message text never clashes.
+constexpr char kOperandMarker = '\x01';
+
+inline std::string operandPlaceholder(int index)
+{
+	return {kOperandMarker, static_cast<char>('0' + index)};
+}
+
+// The text of a record, as process-smi and the trace-dump tool show it
+std::string formatLogRecord(const LogRecord &record, std::string_view logTemplate);
+
+// Fixed-capacity ring of LogRecords; once full, the oldest entries are
+// overwritten. Only the process's current owner appends, and viewers copy
+// the ring through a sequence counter instead of locking out the owner.
+// Slots hold each record as relaxed atomic words, so a viewer that copies a
+// slot while it is rewritten reads a torn value the sequence check throws
+// away, rather than racing the owner.
+class ProcessLog
+{
+public:
+	explicit ProcessLog(size_t capacity) : slots(capacity) {}
+
+	void append(const LogRecord &record)
+	{
+		if (slots.empty())
+			return;
+
+		uint64_t seq = sequence.load(std::memory_order_relaxed);
+		sequence.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		uint64_t index = total.load(std::memory_order_relaxed);
+		slots[index % slots.size()].store(record);
+		total.store(index + 1, std::memory_order_relaxed);
+		sequence.store(seq + 2, std::memory_order_release);
+	}
+
+	// Oldest first. dropped is how many older entries were overwritten.
+	std::vector<LogRecord> snapshot(uint64_t &dropped) const;
+
+	// All retained entries as text, in the old one-string-per-entry layout
+	std::string format() const;
+
+	bool empty() const { return total.load(std::memory_order_relaxed) == 0; }
+
+private:
+	static_assert(std::is_trivially_copyable_v<LogRecord>);
+
+	struct Slot
+	{
+		static constexpr size_t kWords = (sizeof(LogRecord) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+		std::atomic<uint64_t> words[kWords] = {};
+
+		void store(const LogRecord &record)
+		{
+			uint64_t raw[kWords] = {};
+			std::memcpy(raw, &record, sizeof(record));
+			for (size_t i = 0; i < kWords; ++i)
+				words[i].store(raw[i], std::memory_order_relaxed);
+		}
+		LogRecord load() const
+		{
+			uint64_t raw[kWords];
+			for (size_t i = 0; i < kWords; ++i)
+				raw[i] = words[i].load(std::memory_order_relaxed);
+			LogRecord record;
+			std::memcpy(&record, raw, sizeof(record));
+			return record;
+		}
+	};
+
+	std::vector<Slot> slots;
+	std::atomic<uint64_t> total{0};
+	std::atomic<uint64_t> sequence{0};
+};
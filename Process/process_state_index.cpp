@@ -0,0 +1,65 @@
+#include "process_state_index.h"
+#include <algorithm>
+
+void ProcessStateIndex::link(ProcessHotState &hot, ProcessState state)
+{
+	List &list = lists[static_cast<int>(state)];
+	hot.prevInState = list.tail;
+	hot.nextInState = nullptr;
+	if (list.tail)
+		list.tail->nextInState = &hot;
+	else
+		list.head = &hot;
+	list.tail = &hot;
+	counts[static_cast<int>(state)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void ProcessStateIndex::unlink(ProcessHotState &hot, ProcessState state)
+{
+	List &list = lists[static_cast<int>(state)];
+	if (hot.prevInState)
+		hot.prevInState->nextInState = hot.nextInState;
+	else
+		list.head = hot.nextInState;
+	if (hot.nextInState)
+		hot.nextInState->prevInState = hot.prevInState;
+	else
+		list.tail = hot.prevInState;
+	hot.prevInState = hot.nextInState = nullptr;
+	counts[static_cast<int>(state)].fetch_sub(1, std::memory_order_relaxed);
+}
+
+void ProcessStateIndex::insert(ProcessHotState &hot)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	link(hot, hot.state.load(std::memory_order_relaxed));
+}
+
+void ProcessStateIndex::remove(ProcessHotState &hot)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	unlink(hot, hot.state.load(std::memory_order_relaxed));
+}
+
+void ProcessStateIndex::move(ProcessHotState &hot, ProcessState to)
+{
+	ProcessState from = hot.state.load(std::memory_order_relaxed);
+	if (from != to)
+	{
+		unlink(hot, from);
+		link(hot, to);
+	}
+}
+
+std::vector<int> ProcessStateIndex::collect(ProcessState state, size_t limit) const
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	std::vector<int> pids;
+	for (const ProcessHotState *hot = lists[static_cast<int>(state)].tail;
+		 hot && (limit == 0 || pids.size() < limit); hot = hot->prevInState)
+	{
+		pids.push_back(hot->pid);
+	}
+	std::reverse(pids.begin(), pids.end());
+	return pids;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "process_status.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+// Per-state membership of every process, so reports visit only the processes
+// in the state they print and read the counts directly.
+//
+// Each state has an intrusive list threaded through ProcessHotState, in the
+// order processes entered that state. Transitions are O(1) under one mutex;
+// the owning thread calls transition() instead of writing the state itself.
+class ProcessStateIndex
+{
+public:
+	static constexpr int kNumStates = static_cast<int>(ProcessState::FINISHED) + 1;
+
+	// Links a new process into the list for its current state
+	void insert(ProcessHotState &hot);
+	void remove(ProcessHotState &hot);
+	void transition(ProcessHotState &hot, ProcessState to)
+	{
+		transition(hot, to, [] {});
+	}
+
+	// Also runs alsoWrite, which stores other status fields, in the same
+	// seqlock section as the new state
+	template <typename Fn>
+	void transition(ProcessHotState &hot, ProcessState to, Fn alsoWrite)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		move(hot, to);
+		hot.update([&]
+				   {
+			alsoWrite();
+			hot.state.store(to, std::memory_order_relaxed); });
+	}
+
+	int count(ProcessState state) const
+	{
+		return counts[static_cast<int>(state)].load(std::memory_order_relaxed);
+	}
+
+	// Pids of the most recent `limit` entries (0 = all), oldest first
+	std::vector<int> collect(ProcessState state, size_t limit = 0) const;
+
+private:
+	struct List
+	{
+		ProcessHotState *head = nullptr;
+		ProcessHotState *tail = nullptr;
+	};
+
+	std::array<List, kNumStates> lists{};
+	std::array<std::atomic<int>, kNumStates> counts{};
+	mutable std::mutex mtx;
+
+	void link(ProcessHotState &hot, ProcessState state);
+	void unlink(ProcessHotState &hot, ProcessState state);
+	void move(ProcessHotState &hot, ProcessState to);
+};
@@ -0,0 +1,114 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+enum class ProcessState
+{
+	READY,
+	RUNNING,
+	WAITING,
+	BLOCKED, // waiting on the pager for a page fault
+	FINISHED
+};
+
+// What reporters need to know about a process, small enough to copy.
+struct ProcessStatus
+{
+	ProcessState state = ProcessState::READY;
+	int coreId = -1;
+	int currentLine = 0;
+	int totalLines = 0;
+	int migrations = 0; // dispatches on a different core than the previous one
+};
+
+// Identity of a process. ProcessList keeps it for the whole run, so it
+// outlives the process object: once a process finishes and is archived,
+// reports and screen -r work from this record and the archive log alone.
+struct ProcessInfo
+{
+	int pid = 0;
+	std::string name;
+	std::time_t creationTime = 0;
+
+	// Set when the process is archived
+	std::time_t finishTime = 0;
+	int64_t logOffset = -1; // into the archive log file, -1 if it logged nothing
+	uint32_t logBytes = 0;
+};
+
+// Per-tick execution state of a process, kept apart from the cold metadata in
+// `process` and stored in a pid-indexed array by ProcessList.
+//
+// The first cache line is everything dispatch and reporting look at. Its
+// status fields sit behind a seqlock: only the thread currently owning the
+// process writes (ownership is handed over through the ready queue), and
+// readers retry instead of blocking that thread. Fields that change
+// together, like the core, migration count and state on dispatch, are
+// written in one update() so a snapshot never mixes old and new values. Variables get their own
+// line since only instruction execution touches them.
+struct alignas(64) ProcessHotState
+{
+	std::atomic<uint32_t> sequence{0};
+	std::atomic<ProcessState> state{ProcessState::READY};
+	std::atomic<int> coreId{-1};
+	std::atomic<int> currentLine{0};
+	std::atomic<int> totalLines{0};
+	std::atomic<int> migrations{0};
+	int priority = 0;
+	bool sleeping = false;
+	uint8_t sleepTime = 0;
+	int pid = 0;
+
+	// Links in ProcessStateIndex, guarded by its mutex
+	ProcessHotState *prevInState = nullptr;
+	ProcessHotState *nextInState = nullptr;
+
+	alignas(64) std::unordered_map<std::string, uint16_t> variables;
+
+	// Runs fn, which stores status fields, as one write section: read()
+	// sees all of its stores or none of them
+	template <typename Fn>
+	void update(Fn fn)
+	{
+		uint32_t seq = sequence.load(std::memory_order_relaxed);
+		sequence.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		fn();
+		sequence.store(seq + 2, std::memory_order_release);
+	}
+
+	template <typename T, typename V>
+	void set(std::atomic<T> &field, V value)
+	{
+		update([&]
+			   { field.store(static_cast<T>(value), std::memory_order_relaxed); });
+	}
+
+	ProcessStatus read() const
+	{
+		ProcessStatus status;
+		while (true)
+		{
+			uint32_t before = sequence.load(std::memory_order_acquire);
+			if (before & 1)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			status.state = state.load(std::memory_order_relaxed);
+			status.coreId = coreId.load(std::memory_order_relaxed);
+			status.currentLine = currentLine.load(std::memory_order_relaxed);
+			status.totalLines = totalLines.load(std::memory_order_relaxed);
+			status.migrations = migrations.load(std::memory_order_relaxed);
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (sequence.load(std::memory_order_relaxed) == before)
+				return status;
+		}
+	}
+};
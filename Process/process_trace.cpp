@@ -0,0 +1,427 @@
+#include "process_trace.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    const char kMagic[4] = {'P', 'T', 'R', '2'};
+    const char kTrailerMagic[4] = {'P', 'T', 'R', 'X'};
+    const int64_t kTrailerBytes = sizeof(int64_t) + sizeof(kTrailerMagic);
+
+    const uint8_t kTemplateEntry = 1;
+    const uint8_t kRecordEntry = 2;
+    // Records are fixed size, so the writer can walk a buffer and patch
+    // prevOffset in place
+    const size_t kPrevOffsetAt = sizeof(uint8_t) + sizeof(int32_t);
+    const size_t kRecordBytes = kPrevOffsetAt + 2 * sizeof(int64_t) + sizeof(int32_t) + sizeof(int16_t) +
+                                2 * sizeof(uint8_t) + LogRecord::kMaxOperands * sizeof(uint16_t) + sizeof(uint32_t);
+    const size_t kMaxSpareBuffers = 16;
+
+    template <typename T>
+    void putRaw(std::string &buffer, T value)
+    {
+        buffer.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    template <typename T>
+    void writeRaw(std::ofstream &out, T value)
+    {
+        out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    template <typename T>
+    bool readRaw(std::ifstream &in, T &value)
+    {
+        return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(value)));
+    }
+}
+
+ProcessTraceWriter &processTrace()
+{
+    static ProcessTraceWriter trace;
+    return trace;
+}
+
+ProcessTraceWriter::~ProcessTraceWriter()
+{
+    stop();
+}
+
+void ProcessTraceWriter::start(const std::string &path, const std::function<void(std::thread &)> &place)
+{
+    if (running)
+        return;
+
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        return;
+    out.write(kMagic, sizeof(kMagic));
+
+    for (Buffer &buffer : buffers)
+    {
+        buffer.data.clear();
+        buffer.templateIds.clear();
+    }
+    templates.clear();
+    templateIndex.clear();
+    names.clear();
+    offset = sizeof(kMagic);
+    templatesWritten = 0;
+    pids.clear();
+    nextSlot = 0;
+    run++;
+    writerStop = false;
+
+    running = true;
+    writerThread = std::thread(&ProcessTraceWriter::writerThreadFunc, this);
+    if (place)
+        place(writerThread);
+}
+
+void ProcessTraceWriter::stop()
+{
+    if (!running)
+        return;
+
+    // An append that still sees running holds its buffer's lock, so it
+    // lands before the buffer is handed off here; later ones drop out
+    running = false;
+    for (Buffer &buffer : buffers)
+    {
+        std::lock_guard<std::mutex> lock(buffer.mtx);
+        handOff(buffer);
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        writerStop = true;
+    }
+    queueCv.notify_all();
+    if (writerThread.joinable())
+        writerThread.join();
+
+    int64_t indexOffset = offset;
+    writeRaw<uint32_t>(out, static_cast<uint32_t>(templates.size()));
+    for (const std::string &text : templates)
+    {
+        writeRaw<uint16_t>(out, static_cast<uint16_t>(text.size()));
+        out.write(text.data(), text.size());
+    }
+
+    // Pid index, sorted by pid so the tool can print processes in order
+    std::vector<std::pair<int, const PidEntry *>> sorted;
+    for (const auto &entry : pids)
+        sorted.emplace_back(entry.first, &entry.second);
+    std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b)
+              { return a.first < b.first; });
+
+    std::lock_guard<std::mutex> lock(namesMutex);
+    writeRaw<uint32_t>(out, static_cast<uint32_t>(sorted.size()));
+    for (const auto &[pid, entry] : sorted)
+    {
+        const std::string &name = names[pid];
+        writeRaw<int32_t>(out, pid);
+        writeRaw<int64_t>(out, entry->lastOffset);
+        writeRaw<uint32_t>(out, entry->count);
+        writeRaw<uint16_t>(out, static_cast<uint16_t>(name.size()));
+        out.write(name.data(), name.size());
+    }
+    writeRaw<int64_t>(out, indexOffset);
+    out.write(kTrailerMagic, sizeof(kTrailerMagic));
+    out.close();
+}
+
+// Buffer slot of the calling thread, claimed on its first append of a run
+int ProcessTraceWriter::localSlot()
+{
+    thread_local uint64_t slotRun = 0;
+    thread_local int slot = 0;
+    uint64_t current = run.load(std::memory_order_relaxed);
+    if (slotRun != current)
+    {
+        slot = std::min(nextSlot.fetch_add(1, std::memory_order_relaxed), kMaxBuffers - 1);
+        slotRun = current;
+    }
+    return slot;
+}
+
+// Id of the template in the run's string table. The buffer's cache answers
+// repeat templates; only the first use of a template on a core takes
+// templateMutex. Caller holds buffer.mtx.
+uint32_t ProcessTraceWriter::internTemplate(Buffer &buffer, std::string_view logTemplate)
+{
+    logTemplate = logTemplate.substr(0, UINT16_MAX);
+    auto cached = buffer.templateIds.find(logTemplate);
+    if (cached != buffer.templateIds.end())
+        return cached->second;
+
+    std::lock_guard<std::mutex> lock(templateMutex);
+    auto it = templateIndex.find(logTemplate);
+    if (it == templateIndex.end())
+    {
+        const std::string &text = templates.emplace_back(logTemplate);
+        it = templateIndex.emplace(text, static_cast<uint32_t>(templates.size() - 1)).first;
+    }
+    buffer.templateIds.emplace(it->first, it->second);
+    return it->second;
+}
+
+// Queues the buffer's records for the writer and gives it an empty buffer
+// back. Caller holds buffer.mtx.
+void ProcessTraceWriter::handOff(Buffer &buffer)
+{
+    if (buffer.data.empty())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queue.push_back(std::move(buffer.data));
+        buffer.data = std::string();
+        if (!spare.empty())
+        {
+            buffer.data.swap(spare.back());
+            spare.pop_back();
+        }
+    }
+    queueCv.notify_one();
+}
+
+void ProcessTraceWriter::append(int pid, const std::string &name, int &traceSlot, const LogRecord &record, std::string_view logTemplate)
+{
+    if (!running.load(std::memory_order_relaxed))
+        return;
+
+    int slot = localSlot();
+    if (traceSlot != slot)
+    {
+        if (traceSlot < 0)
+        {
+            std::lock_guard<std::mutex> lock(namesMutex);
+            names.emplace(pid, name);
+        }
+        else if (traceSlot < kMaxBuffers)
+        {
+            // The process moved cores: its earlier records go to the
+            // writer before any it logs here
+            Buffer &previous = buffers[traceSlot];
+            std::lock_guard<std::mutex> lock(previous.mtx);
+            handOff(previous);
+        }
+        traceSlot = slot;
+    }
+
+    Buffer &buffer = buffers[slot];
+    std::lock_guard<std::mutex> lock(buffer.mtx);
+    if (!running.load(std::memory_order_relaxed))
+        return;
+
+    if (buffer.data.capacity() < kBufferBytes)
+        buffer.data.reserve(kBufferBytes + kRecordBytes);
+    putRaw<uint8_t>(buffer.data, kRecordEntry);
+    putRaw<int32_t>(buffer.data, pid);
+    putRaw<int64_t>(buffer.data, -1); // prevOffset, set by the writer
+    putRaw<int64_t>(buffer.data, static_cast<int64_t>(record.timestamp));
+    putRaw<int32_t>(buffer.data, record.line);
+    putRaw<int16_t>(buffer.data, record.coreId);
+    putRaw<uint8_t>(buffer.data, static_cast<uint8_t>(record.op));
+    putRaw<uint8_t>(buffer.data, record.missing);
+    for (uint16_t operand : record.operands)
+        putRaw<uint16_t>(buffer.data, operand);
+    putRaw<uint32_t>(buffer.data, internTemplate(buffer, logTemplate));
+
+    if (buffer.data.size() >= kBufferBytes)
+        handOff(buffer);
+}
+
+// Writes the templates interned since the last chunk, then the chunk with
+// each record linked to its pid's previous one
+void ProcessTraceWriter::writeChunk(std::string &chunk)
+{
+    std::string table;
+    {
+        std::lock_guard<std::mutex> lock(templateMutex);
+        for (; templatesWritten < templates.size(); ++templatesWritten)
+        {
+            const std::string &text = templates[templatesWritten];
+            putRaw<uint8_t>(table, kTemplateEntry);
+            putRaw<uint32_t>(table, static_cast<uint32_t>(templatesWritten));
+            putRaw<uint16_t>(table, static_cast<uint16_t>(text.size()));
+            table.append(text);
+        }
+    }
+    out.write(table.data(), table.size());
+    offset += static_cast<int64_t>(table.size());
+
+    for (size_t at = 0; at + kRecordBytes <= chunk.size(); at += kRecordBytes)
+    {
+        int32_t pid = 0;
+        std::memcpy(&pid, chunk.data() + at + sizeof(uint8_t), sizeof(pid));
+        PidEntry &entry = pids[pid];
+        std::memcpy(chunk.data() + at + kPrevOffsetAt, &entry.lastOffset, sizeof(entry.lastOffset));
+        entry.lastOffset = offset + static_cast<int64_t>(at);
+        entry.count++;
+    }
+    out.write(chunk.data(), chunk.size());
+    offset += static_cast<int64_t>(chunk.size());
+}
+
+void ProcessTraceWriter::writerThreadFunc()
+{
+    std::deque<std::string> batch;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCv.wait(lock, [this]
+                         { return !queue.empty() || writerStop; });
+            if (queue.empty())
+                break;
+            batch.swap(queue);
+        }
+
+        for (auto &chunk : batch)
+            writeChunk(chunk);
+        out.flush();
+
+        std::lock_guard<std::mutex> lock(queueMutex);
+        for (auto &chunk : batch)
+        {
+            if (spare.size() >= kMaxSpareBuffers)
+                break;
+            chunk.clear();
+            spare.push_back(std::move(chunk));
+        }
+        batch.clear();
+    }
+}
+
+ProcessTraceReader::ProcessTraceReader(const std::string &path)
+    : in(path, std::ios::binary)
+{
+    char magic[sizeof(kMagic)];
+    if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), kMagic))
+        return;
+    valid = true;
+    position = sizeof(kMagic);
+
+    in.seekg(0, std::ios::end);
+    int64_t fileSize = static_cast<int64_t>(in.tellg());
+    recordsEnd = fileSize;
+
+    // Load the string table and pid index if the writer got to close the trace
+    int64_t indexOffset = 0;
+    char trailer[sizeof(kTrailerMagic)];
+    if (fileSize >= position + kTrailerBytes)
+    {
+        in.seekg(fileSize - kTrailerBytes);
+        if (readRaw(in, indexOffset) && in.read(trailer, sizeof(trailer)) &&
+            std::equal(trailer, trailer + sizeof(trailer), kTrailerMagic) &&
+            indexOffset >= position && indexOffset <= fileSize - kTrailerBytes)
+        {
+            recordsEnd = indexOffset;
+            in.seekg(indexOffset);
+            uint32_t numTemplates = 0;
+            readRaw(in, numTemplates);
+            for (uint32_t i = 0; i < numTemplates; ++i)
+            {
+                uint16_t length = 0;
+                if (!readRaw(in, length))
+                    break;
+                std::string &text = templates.emplace_back(length, '\0');
+                in.read(text.data(), length);
+            }
+
+            uint32_t numPids = 0;
+            readRaw(in, numPids);
+            for (uint32_t i = 0; i < numPids; ++i)
+            {
+                PidInfo info;
+                int32_t pid = 0;
+                uint16_t nameLength = 0;
+                if (!readRaw(in, pid) || !readRaw(in, info.lastOffset) || !readRaw(in, info.count) ||
+                    !readRaw(in, nameLength))
+                    break;
+                info.pid = pid;
+                info.name.resize(nameLength);
+                in.read(info.name.data(), nameLength);
+                pidIndex.push_back(std::move(info));
+            }
+        }
+    }
+    in.clear();
+}
+
+// Reads a string-table entry whose kind byte has been consumed
+bool ProcessTraceReader::readTemplateEntry()
+{
+    uint32_t id = 0;
+    uint16_t length = 0;
+    if (!readRaw(in, id) || !readRaw(in, length))
+        return false;
+    std::string text(length, '\0');
+    if (!in.read(text.data(), length))
+        return false;
+    if (id >= templates.size())
+        templates.resize(id + 1);
+    templates[id] = std::move(text);
+    return true;
+}
+
+bool ProcessTraceReader::readAt(int64_t offset, Entry &entry)
+{
+    if (offset < static_cast<int64_t>(sizeof(kMagic)) || offset >= recordsEnd)
+        return false;
+
+    in.clear();
+    in.seekg(offset);
+
+    uint8_t kind = 0;
+    int32_t pid = 0;
+    int64_t timestamp = 0;
+    int32_t line = 0;
+    int16_t coreId = 0;
+    uint8_t op = 0, missing = 0;
+    uint32_t templateId = 0;
+    if (!readRaw(in, kind) || kind != kRecordEntry)
+        return false;
+    if (!readRaw(in, pid) || !readRaw(in, entry.prevOffset) || !readRaw(in, timestamp) ||
+        !readRaw(in, line) || !readRaw(in, coreId) || !readRaw(in, op) || !readRaw(in, missing))
+        return false;
+    for (uint16_t &operand : entry.record.operands)
+    {
+        if (!readRaw(in, operand))
+            return false;
+    }
+    if (!readRaw(in, templateId))
+        return false;
+
+    entry.offset = offset;
+    entry.pid = pid;
+    entry.record.timestamp = static_cast<std::time_t>(timestamp);
+    entry.record.line = line;
+    entry.record.coreId = coreId;
+    entry.record.op = static_cast<LogOp>(op);
+    entry.record.missing = missing;
+    entry.record.source = nullptr;
+    entry.logTemplate = templateId < templates.size() ? templates[templateId] : std::string();
+    return true;
+}
+
+bool ProcessTraceReader::next(Entry &entry)
+{
+    // String-table entries precede the records that use them
+    while (position < recordsEnd)
+    {
+        in.clear();
+        in.seekg(position);
+        uint8_t kind = 0;
+        if (!readRaw(in, kind) || kind != kTemplateEntry)
+            break;
+        if (!readTemplateEntry())
+            return false;
+        position = static_cast<int64_t>(in.tellg());
+    }
+
+    if (!readAt(position, entry))
+        return false;
+    position = static_cast<int64_t>(in.tellg());
+    return true;
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <atomic>
+#include <cstdint>
+#include "process_log.h"
+
+// Every log record of a run is also streamed to one append-only binary trace
+// file, so logs outlive the in-memory ring and the run itself. Each appending
+// thread (in practice, each worker core) serialises records into its own
+// buffer; full buffers are handed to a background thread that writes them.
+// A process's records stay in order across cores because, when it logs on a
+// new core, the buffer holding its previous records is handed off first.
+//
+// Log templates are interned: each distinct template is written once as a
+// string-table entry, ahead of the first record that uses it, and records
+// carry only its id. Each record points back at the previous record of the
+// same pid (filled in by the writer thread, which knows file offsets), and
+// stop() appends the string table and a pid index, so one process's log can
+// be read without scanning the file. The trace-dump tool renders it as text.
+//
+// File layout (host byte order):
+//   header:    "PTR2"
+//   template:  uint8 kTemplateEntry, uint32 id, uint16 length, bytes
+//   record:    uint8 kRecordEntry, int32 pid, int64 prevOffset (-1 for the
+//              pid's first record), int64 timestamp, int32 line, int16 coreId,
+//              uint8 op, uint8 missing, 4 x uint16 operands, uint32 templateId
+//   index:     uint32 numTemplates, numTemplates x (uint16 length, bytes),
+//              uint32 numPids, numPids x (int32 pid, int64 lastOffset,
+//              uint32 count, uint16 nameLength, name bytes)
+//   trailer:   int64 indexOffset, "PTRX"
+// A trace cut short by a crash has no index but can still be read in order.
+
+class ProcessTraceWriter
+{
+public:
+    static constexpr size_t kBufferBytes = 256 << 10; // per thread
+    static constexpr int kMaxBuffers = 64;            // threads beyond this share the last buffer
+
+    ~ProcessTraceWriter();
+
+    // place, if given, is called with the writer thread once it exists
+    void start(const std::string &path, const std::function<void(std::thread &)> &place = {});
+    void stop();
+
+    // traceSlot is the caller's (one per process): the buffer holding its
+    // latest records, -1 before its first record
+    void append(int pid, const std::string &name, int &traceSlot, const LogRecord &record, std::string_view logTemplate);
+
+private:
+    struct Buffer
+    {
+        std::mutex mtx; // uncontended unless another core hands this buffer off
+        std::string data;
+        std::unordered_map<std::string_view, uint32_t> templateIds; // local cache of templateIndex
+    };
+
+    struct PidEntry
+    {
+        int64_t lastOffset = -1;
+        uint32_t count = 0;
+    };
+
+    std::ofstream out;
+    std::atomic<bool> running{false};
+
+    std::array<Buffer, kMaxBuffers> buffers;
+    std::atomic<int> nextSlot{0};
+    std::atomic<uint64_t> run{0}; // bumped by start() so threads claim fresh slots
+
+    std::mutex templateMutex; // guards templates and templateIndex
+    std::deque<std::string> templates; // by id; deque so views stay valid
+    std::unordered_map<std::string_view, uint32_t> templateIndex;
+
+    std::mutex namesMutex;
+    std::unordered_map<int, std::string> names; // taken once per process
+
+    // Writer thread only (and stop() once it has joined)
+    int64_t offset = 0; // file offset of the end of what has been written
+    size_t templatesWritten = 0;
+    std::unordered_map<int, PidEntry> pids;
+
+    std::thread writerThread;
+    std::mutex queueMutex;
+    std::condition_variable queueCv;
+    std::deque<std::string> queue; // full buffers waiting to be written
+    bool writerStop = false;       // set by stop() after the last hand-off
+    std::vector<std::string> spare; // written buffers, reused by handOff
+
+    int localSlot();
+    uint32_t internTemplate(Buffer &buffer, std::string_view logTemplate);
+    void handOff(Buffer &buffer);
+    void writeChunk(std::string &chunk);
+    void writerThreadFunc();
+};
+
+// Shared by every process
+ProcessTraceWriter &processTrace();
+
+class ProcessTraceReader
+{
+public:
+    struct Entry
+    {
+        int64_t offset = 0;
+        int pid = 0;
+        int64_t prevOffset = -1;
+        LogRecord record; // source is always null
+        std::string logTemplate;
+    };
+
+    struct PidInfo
+    {
+        int pid = 0;
+        int64_t lastOffset = -1;
+        uint32_t count = 0;
+        std::string name;
+    };
+
+    explicit ProcessTraceReader(const std::string &path);
+    bool isOpen() const { return in.is_open() && valid; }
+
+    // Records in file order; false at the end of the records
+    bool next(Entry &entry);
+    bool readAt(int64_t offset, Entry &entry);
+
+    // Empty if the trace was not closed cleanly
+    const std::vector<PidInfo> &getPidIndex() const { return pidIndex; }
+
+private:
+    std::ifstream in;
+    bool valid = false;
+    int64_t position = 0;
+    int64_t recordsEnd = 0;
+    std::vector<std::string> templates; // by id
+    std::vector<PidInfo> pidIndex;
+
+    bool readTemplateEntry();
+};
@@ -0,0 +1,172 @@
+#include "host_placement.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // First line of a sysfs file, or "" if it cannot be read
+    std::string readLine(const fs::path &path)
+    {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        return line;
+    }
+}
+
+std::vector<int> HostPlacement::readOnlineCpus()
+{
+    std::vector<int> cpus;
+    try
+    {
+        cpus = parseCpuList(readLine("/sys/devices/system/cpu/online"));
+    }
+    catch (const std::invalid_argument &)
+    {
+    }
+    if (cpus.empty())
+    {
+        unsigned int count = (std::max)(std::thread::hardware_concurrency(), 1u);
+        for (unsigned int cpu = 0; cpu < count; ++cpu)
+            cpus.push_back(static_cast<int>(cpu));
+    }
+    return cpus;
+}
+
+std::vector<int> HostPlacement::readCpuNodes()
+{
+    std::vector<int> nodes;
+    std::error_code ec;
+    for (const auto &entry : fs::directory_iterator("/sys/devices/system/node", ec))
+    {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("node", 0) != 0 || name.size() == 4 ||
+            !std::all_of(name.begin() + 4, name.end(), ::isdigit))
+            continue;
+
+        int node = std::stoi(name.substr(4));
+        try
+        {
+            for (int cpu : parseCpuList(readLine(entry.path() / "cpulist")))
+            {
+                if (cpu >= static_cast<int>(nodes.size()))
+                    nodes.resize(cpu + 1, 0);
+                nodes[cpu] = node;
+            }
+        }
+        catch (const std::invalid_argument &)
+        {
+        }
+    }
+    return nodes;
+}
+
+HostPlacement::HostPlacement(const Config &config)
+    : housekeepingCpus(config.getHousekeepingCpus()), cpuNode(readCpuNodes())
+{
+    NumaPlacement numa = config.getNumaPlacement();
+    std::vector<int> candidates = config.getWorkerCpus();
+    if (candidates.empty() && numa != NumaPlacement::None)
+    {
+        for (int cpu : readOnlineCpus())
+        {
+            if (std::find(housekeepingCpus.begin(), housekeepingCpus.end(), cpu) == housekeepingCpus.end())
+                candidates.push_back(cpu);
+        }
+    }
+    if (numa == NumaPlacement::None || candidates.empty())
+    {
+        workerCpus = candidates;
+        return;
+    }
+
+    std::map<int, std::vector<int>> byNode;
+    for (int cpu : candidates)
+        byNode[nodeOf(cpu)].push_back(cpu);
+
+    if (numa == NumaPlacement::Compact)
+    {
+        for (const auto &[node, cpus] : byNode)
+            workerCpus.insert(workerCpus.end(), cpus.begin(), cpus.end());
+        return;
+    }
+
+    // Spread: one CPU from each node in turn
+    for (size_t i = 0; workerCpus.size() < candidates.size(); ++i)
+    {
+        for (const auto &[node, cpus] : byNode)
+        {
+            if (i < cpus.size())
+                workerCpus.push_back(cpus[i]);
+        }
+    }
+}
+
+int HostPlacement::workerCpu(int core) const
+{
+    if (workerCpus.empty())
+        return -1;
+    return workerCpus[core % workerCpus.size()];
+}
+
+int HostPlacement::nodeOf(int cpu) const
+{
+    return cpu >= 0 && cpu < static_cast<int>(cpuNode.size()) ? cpuNode[cpu] : 0;
+}
+
+bool HostPlacement::pin(std::thread &thread, const std::vector<int> &cpus)
+{
+    if (cpus.empty())
+        return true;
+#ifdef _WIN32
+    DWORD_PTR mask = 0;
+    for (int cpu : cpus)
+    {
+        if (cpu < static_cast<int>(sizeof(DWORD_PTR) * 8))
+            mask |= static_cast<DWORD_PTR>(1) << cpu;
+    }
+    return mask != 0 && SetThreadAffinityMask(thread.native_handle(), mask) != 0;
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus)
+    {
+        if (cpu < CPU_SETSIZE)
+            CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#endif
+}
+
+std::string HostPlacement::describe() const
+{
+    std::ostringstream out;
+    if (workerCpus.empty())
+        out << "workers unpinned";
+    else
+    {
+        out << "workers on CPUs";
+        for (size_t i = 0; i < workerCpus.size(); ++i)
+            out << (i ? "," : " ") << workerCpus[i] << "(node " << nodeOf(workerCpus[i]) << ")";
+    }
+    if (!housekeepingCpus.empty())
+    {
+        out << ", housekeeping on CPUs";
+        for (size_t i = 0; i < housekeepingCpus.size(); ++i)
+            out << (i ? "," : " ") << housekeepingCpus[i];
+    }
+    return out.str();
+}
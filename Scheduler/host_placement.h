@@ -0,0 +1,42 @@
+#pragma once
+#include <string>
+#include <thread>
+#include <vector>
+#include "Config.h"
+
+// Where the emulator's threads run on the host. Each emulated core's worker
+// gets one host CPU, and the background threads (pager, batch generator,
+// clock ticker, console output, trace and memory stamp writers) share the
+// housekeeping CPUs, so benchmark runs are not reshuffled by the OS
+// scheduler between samples.
+//
+// Worker CPUs come from worker-cpus or, when only numa-placement is set,
+// from every online CPU that is not a housekeeping CPU. numa-placement then
+// orders them by NUMA node (read from /sys/devices/system/node); emulated
+// core i runs on the i-th CPU of that order, wrapping when num-cpu exceeds
+// it. With neither key set nothing is pinned.
+class HostPlacement
+{
+public:
+    explicit HostPlacement(const Config &config);
+
+    bool pinsWorkers() const { return !workerCpus.empty(); }
+    // Host CPU for emulated core `core`, -1 when workers are not pinned
+    int workerCpu(int core) const;
+    const std::vector<int> &getHousekeepingCpus() const { return housekeepingCpus; }
+    int nodeOf(int cpu) const;
+
+    // Restricts the thread to the given CPUs; no-op for an empty set.
+    // Returns false if the host refused or pinning is unsupported here.
+    static bool pin(std::thread &thread, const std::vector<int> &cpus);
+
+    std::string describe() const;
+
+private:
+    std::vector<int> workerCpus;       // in assignment order
+    std::vector<int> housekeepingCpus;
+    std::vector<int> cpuNode;          // cpuNode[cpu] = NUMA node, 0 if unknown
+
+    static std::vector<int> readOnlineCpus();
+    static std::vector<int> readCpuNodes();
+};
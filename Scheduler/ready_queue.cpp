@@ -0,0 +1,654 @@
+#include "ready_queue.h"
+#include <algorithm>
+#include <bit>
+
+void FifoReadyQueue::push(const process &proc)
+{
+    int pinned = proc.getPinnedCore();
+    if (pinned >= 0 && pinned < static_cast<int>(pinnedCount.size()))
+        pinnedCount[pinned]++;
+    else
+    {
+        pinned = -1;
+        unpinnedCount++;
+    }
+    queue.push_back({proc.getPid(), proc.getCoreId(), pinned, 0});
+}
+
+void FifoReadyQueue::take(size_t index, int &pid)
+{
+    const Entry &entry = queue[index];
+    pid = entry.pid;
+    if (entry.pinnedCore >= 0)
+        pinnedCount[entry.pinnedCore]--;
+    else
+        unpinnedCount--;
+    queue.erase(queue.begin() + index);
+}
+
+bool FifoReadyQueue::pop(int coreId, int &pid)
+{
+    auto allowed = [coreId](const Entry &entry)
+    {
+        return entry.pinnedCore < 0 || entry.pinnedCore == coreId;
+    };
+
+    size_t first = 0;
+    while (first < queue.size() && !allowed(queue[first]))
+        first++;
+    if (first == queue.size())
+        return false;
+
+    Entry &oldest = queue[first];
+    if (oldest.lastCore >= 0 && oldest.lastCore != coreId && oldest.skips < kMaxSkips)
+    {
+        size_t end = std::min(queue.size(), first + 1 + kAffinityWindow);
+        for (size_t i = first + 1; i < end; ++i)
+        {
+            if (allowed(queue[i]) && queue[i].lastCore == coreId)
+            {
+                oldest.skips++;
+                take(i, pid);
+                return true;
+            }
+        }
+    }
+    take(first, pid);
+    return true;
+}
+
+AdaptiveFifoReadyQueue::AdaptiveFifoReadyQueue(int numCores, int initialQuantum, int minQuantum, int maxQuantum)
+    : FifoReadyQueue(numCores, initialQuantum),
+      numCores(numCores),
+      minQuantum(minQuantum),
+      maxQuantum(maxQuantum),
+      averageBurst(std::clamp(initialQuantum, minQuantum, maxQuantum)),
+      runningSlice(numCores, minQuantum)
+{
+}
+
+void AdaptiveFifoReadyQueue::observe(ProcState &state, double ran)
+{
+    state.burst = 0.5 * state.burst + 0.5 * ran;
+    averageBurst = 0.9 * averageBurst + 0.1 * ran;
+}
+
+void AdaptiveFifoReadyQueue::push(const process &proc)
+{
+    int line = proc.getCurrentLine();
+    auto [it, inserted] = states.try_emplace(proc.getPid(), ProcState{averageBurst, line});
+    ProcState &state = it->second;
+    if (state.slice > 0)
+    {
+        int ran = line - state.lastLine;
+        bool usedUp = ran >= state.slice && !proc.isSleeping();
+        observe(state, usedUp ? 2.0 * ran : std::max(ran, 1));
+        state.slice = 0;
+    }
+    state.lastLine = line;
+    FifoReadyQueue::push(proc);
+}
+
+bool AdaptiveFifoReadyQueue::pop(int coreId, int &pid)
+{
+    if (!FifoReadyQueue::pop(coreId, pid))
+        return false;
+
+    int cap = static_cast<int>(static_cast<long long>(maxQuantum) * numCores / std::max<size_t>(numCores, size() + 1));
+    cap = std::max(cap, minQuantum);
+    ProcState &state = states[pid];
+    state.slice = std::clamp(static_cast<int>(state.burst * 1.25 + 0.5), minQuantum, cap);
+    runningSlice[coreId] = state.slice;
+    return true;
+}
+
+void AdaptiveFifoReadyQueue::remove(const process &proc)
+{
+    auto it = states.find(proc.getPid());
+    if (it == states.end())
+        return;
+    if (it->second.slice > 0)
+        averageBurst = 0.9 * averageBurst + 0.1 * std::max(proc.getCurrentLine() - it->second.lastLine, 1);
+    states.erase(it);
+}
+
+PriorityReadyQueue::PriorityReadyQueue(int numCores)
+    : numCores(numCores), cores(new CoreQueue[numCores])
+{
+}
+
+int PriorityReadyQueue::levelOf(int priority)
+{
+    return std::clamp(priority, 0, kLevels - 1);
+}
+
+int PriorityReadyQueue::highest(const CoreQueue &core)
+{
+    return core.nonEmpty == 0 ? -1 : 31 - std::countl_zero(core.nonEmpty);
+}
+
+void PriorityReadyQueue::add(CoreQueue &core, int level, int pid)
+{
+    core.buckets[level].push_back(pid);
+    core.nonEmpty |= 1u << level;
+    core.count++;
+    core.topLevel.store(highest(core), std::memory_order_relaxed);
+}
+
+int PriorityReadyQueue::take(CoreQueue &core, int level)
+{
+    auto &bucket = core.buckets[level];
+    int pid = bucket.front();
+    bucket.pop_front();
+    if (bucket.empty())
+        core.nonEmpty &= ~(1u << level);
+    core.count--;
+    core.topLevel.store(highest(core), std::memory_order_relaxed);
+    return pid;
+}
+
+void PriorityReadyQueue::push(const process &proc)
+{
+    // Prefer the core doing the least important work, then the shorter
+    // queue, then the core the process last ran on
+    int level = levelOf(proc.getPriority());
+    int lastCore = proc.getCoreId();
+    int target = 0;
+    for (int i = 1; i < numCores; ++i)
+    {
+        const CoreQueue &best = cores[target];
+        const CoreQueue &candidate = cores[i];
+        if (candidate.runningLevel != best.runningLevel)
+        {
+            if (candidate.runningLevel < best.runningLevel)
+                target = i;
+        }
+        else if (candidate.count != best.count)
+        {
+            if (candidate.count < best.count)
+                target = i;
+        }
+        else if (i == lastCore)
+        {
+            target = i;
+        }
+    }
+
+    add(cores[target], level, proc.getPid());
+    total++;
+}
+
+bool PriorityReadyQueue::pop(int coreId, int &pid)
+{
+    if (total == 0)
+        return false;
+
+    // Own queue first; steal only when it is empty
+    int source = coreId;
+    if (cores[coreId].count == 0)
+    {
+        int bestLevel = -1;
+        for (int i = 0; i < numCores; ++i)
+        {
+            int level = highest(cores[i]);
+            if (level > bestLevel)
+            {
+                bestLevel = level;
+                source = i;
+            }
+        }
+    }
+
+    CoreQueue &core = cores[source];
+    int level = highest(core);
+    pid = take(core, level);
+    total--;
+    cores[coreId].runningLevel = level;
+
+    if (++popsSinceAging >= kAgingInterval)
+    {
+        popsSinceAging = 0;
+        age();
+    }
+    return true;
+}
+
+// Against the level the process was popped at, not its base priority: an
+// aged process keeps its boosted level until its slice ends. runningLevel
+// is only written by this core's own worker, so no lock is needed.
+bool PriorityReadyQueue::shouldPreempt(int coreId, const process &) const
+{
+    return cores[coreId].topLevel.load(std::memory_order_relaxed) > cores[coreId].runningLevel;
+}
+
+void PriorityReadyQueue::age()
+{
+    for (int i = 0; i < numCores; ++i)
+    {
+        CoreQueue &core = cores[i];
+        // Walk top-down so an entry moves at most one level per step
+        for (int level = kLevels - 2; level >= 0; --level)
+        {
+            if (core.nonEmpty & (1u << level))
+                add(core, level + 1, take(core, level));
+        }
+    }
+}
+
+CorePreemption::CorePreemption(int numCores)
+    : running(numCores, kIdle), requests(new std::atomic<int64_t>[numCores])
+{
+    for (int i = 0; i < numCores; ++i)
+        requests[i].store(kNone, std::memory_order_relaxed);
+}
+
+void CorePreemption::started(int coreId, int64_t key)
+{
+    running[coreId] = key;
+    requests[coreId].store(kNone, std::memory_order_relaxed);
+}
+
+void CorePreemption::stopped(int coreId)
+{
+    running[coreId] = kIdle;
+    requests[coreId].store(kNone, std::memory_order_relaxed);
+}
+
+void CorePreemption::arrived(int64_t key)
+{
+    int victim = -1;
+    for (size_t i = 0; i < running.size(); ++i)
+    {
+        if (running[i] == kIdle)
+            return;
+        if (running[i] > key && requests[i].load(std::memory_order_relaxed) == kNone &&
+            (victim < 0 || running[i] > running[victim]))
+            victim = static_cast<int>(i);
+    }
+    if (victim >= 0)
+        requests[victim].store(key, std::memory_order_relaxed);
+}
+
+void CorePreemption::withdraw(int64_t bestWaiting)
+{
+    for (size_t i = 0; i < running.size(); ++i)
+    {
+        if (running[i] <= bestWaiting)
+            requests[i].store(kNone, std::memory_order_relaxed);
+    }
+}
+
+void CorePreemption::promoteAll(int64_t key)
+{
+    for (size_t i = 0; i < running.size(); ++i)
+    {
+        if (running[i] != kIdle)
+            running[i] = std::min(running[i], key);
+        requests[i].store(kNone, std::memory_order_relaxed);
+    }
+}
+
+MlfqReadyQueue::MlfqReadyQueue(int numCores, std::vector<int> quanta, int boostInterval)
+    : quanta(std::move(quanta)),
+      levels(this->quanta.size()),
+      running(numCores),
+      preemption(numCores),
+      topLevel(static_cast<int>(this->quanta.size())),
+      boostInterval(boostInterval)
+{
+}
+
+void MlfqReadyQueue::updateTopLevel()
+{
+    int top = static_cast<int>(levels.size());
+    for (int l = 0; l < top; ++l)
+    {
+        if (!levels[l].queue.empty())
+        {
+            top = l;
+            break;
+        }
+    }
+    topLevel = top;
+}
+
+void MlfqReadyQueue::push(const process &proc)
+{
+    auto [it, inserted] = states.try_emplace(proc.getPid());
+    ProcState &state = it->second;
+    int line = proc.getCurrentLine();
+    if (!inserted)
+    {
+        // Charge what ran since it was last queued against this level
+        state.used += line - state.lastLine;
+        if (state.used >= quanta[state.level])
+        {
+            state.level = std::min(state.level + 1, static_cast<int>(levels.size()) - 1);
+            state.used = 0;
+        }
+    }
+    state.lastLine = line;
+
+    levels[state.level].queue.push_back({proc.getPid(), Clock::now()});
+    total++;
+    topLevel = std::min(topLevel, state.level);
+    preemption.arrived(state.level);
+}
+
+bool MlfqReadyQueue::pop(int coreId, int &pid)
+{
+    int top = topLevel;
+    if (total == 0 || top >= static_cast<int>(levels.size()))
+        return false;
+
+    Level &level = levels[top];
+    Waiting entry = level.queue.front();
+    level.queue.pop_front();
+    level.dispatched++;
+    level.totalWait += Clock::now() - entry.since;
+    total--;
+    updateTopLevel();
+
+    pid = entry.pid;
+    const ProcState &state = states[pid];
+    running[coreId] = {top, std::max(quanta[top] - state.used, 1)};
+    preemption.started(coreId, top);
+    preemption.withdraw(topLevel < static_cast<int>(levels.size()) ? topLevel : CorePreemption::kNone);
+
+    if (boostInterval > 0 && ++popsSinceBoost >= boostInterval)
+    {
+        popsSinceBoost = 0;
+        boost();
+    }
+    return true;
+}
+
+bool MlfqReadyQueue::shouldPreempt(int coreId, const process &) const
+{
+    return preemption.requestedBy(coreId) != CorePreemption::kNone;
+}
+
+void MlfqReadyQueue::boost()
+{
+    for (auto &[pid, state] : states)
+    {
+        state.level = 0;
+        state.used = 0;
+    }
+    for (size_t l = 1; l < levels.size(); ++l)
+    {
+        auto &queue = levels[l].queue;
+        levels[0].queue.insert(levels[0].queue.end(), queue.begin(), queue.end());
+        queue.clear();
+    }
+    updateTopLevel();
+    // Running processes were boosted too, so nothing queued outranks them
+    preemption.promoteAll(0);
+}
+
+std::vector<ReadyLevelStats> MlfqReadyQueue::levelStats() const
+{
+    std::vector<ReadyLevelStats> stats;
+    for (size_t l = 0; l < levels.size(); ++l)
+    {
+        const Level &level = levels[l];
+        double avgWaitMs = 0.0;
+        if (level.dispatched > 0)
+            avgWaitMs = std::chrono::duration<double, std::milli>(level.totalWait).count() / level.dispatched;
+        stats.push_back({static_cast<int>(l), quanta[l], level.queue.size(), level.dispatched, avgWaitMs});
+    }
+    return stats;
+}
+
+void ShortestRemainingReadyQueue::push(const process &proc)
+{
+    int remaining = remainingOf(proc);
+    heap.push({remaining, nextSeq++, proc.getPid()});
+    if (preemptive)
+        preemption.arrived(remaining);
+}
+
+bool ShortestRemainingReadyQueue::pop(int coreId, int &pid)
+{
+    if (heap.empty())
+        return false;
+    Entry entry = heap.top();
+    heap.pop();
+    pid = entry.pid;
+    preemption.started(coreId, entry.remaining);
+    preemption.withdraw(heap.empty() ? CorePreemption::kNone : heap.top().remaining);
+    return true;
+}
+
+// The running key is the count at pop, so the victim was picked on a stale
+// count; it only yields if the arrival is still shorter than what it has left
+bool ShortestRemainingReadyQueue::shouldPreempt(int coreId, const process &proc) const
+{
+    return preemptive && preemption.requestedBy(coreId) < remainingOf(proc);
+}
+
+StrideReadyQueue::StrideReadyQueue(int quantum, int defaultTickets, const std::vector<std::pair<std::string, int>> &groupTickets)
+    : quantum(std::max(quantum, 1)), defaultTickets(defaultTickets)
+{
+    for (const auto &[name, tickets] : groupTickets)
+        groups[groupFor(name)].tickets = tickets;
+    for (Group &group : groups)
+        group.stride = kStride1 / group.tickets;
+}
+
+int StrideReadyQueue::groupFor(const std::string &name)
+{
+    auto [it, inserted] = groupIndex.try_emplace(name, static_cast<int>(groups.size()));
+    if (inserted)
+    {
+        Group group;
+        group.name = name;
+        group.tickets = defaultTickets;
+        group.stride = kStride1 / defaultTickets;
+        group.pass = globalPass;
+        groups.push_back(std::move(group));
+    }
+    return it->second;
+}
+
+// Charges what ran since the process was last queued and, if it was
+// dispatched, settles the quantum its group was charged up front
+void StrideReadyQueue::settle(ProcState &state, int line)
+{
+    Group &group = groups[state.group];
+    uint64_t ran = static_cast<uint64_t>(std::max(line - state.lastLine, 0));
+    state.lastLine = line;
+    state.pass += ran * state.stride;
+    if (state.dispatched)
+    {
+        state.dispatched = false;
+        group.running--;
+        group.pass = group.pass - quantum * group.stride + ran * group.stride;
+        group.ticks += ran;
+    }
+}
+
+void StrideReadyQueue::push(const process &proc)
+{
+    int line = proc.getCurrentLine();
+    auto it = states.find(proc.getPid());
+    if (it == states.end())
+    {
+        int tickets = proc.getTickets() > 0 ? proc.getTickets() : defaultTickets;
+        int g = groupFor(proc.getGroup());
+        it = states.emplace(proc.getPid(), ProcState{g, kStride1 / tickets, groups[g].lastPass, line}).first;
+    }
+    ProcState &state = it->second;
+    settle(state, line);
+
+    Group &group = groups[state.group];
+    if (group.queue.empty() && group.running == 0)
+        group.pass = std::max(group.pass, globalPass);
+    group.queue.push({state.pass, nextSeq++, proc.getPid()});
+    total++;
+}
+
+bool StrideReadyQueue::pop(int, int &pid)
+{
+    if (total == 0)
+        return false;
+
+    Group *best = nullptr;
+    for (Group &group : groups)
+    {
+        if (!group.queue.empty() && (best == nullptr || group.pass < best->pass))
+            best = &group;
+    }
+
+    Waiting entry = best->queue.top();
+    best->queue.pop();
+    total--;
+
+    globalPass = best->pass;
+    best->lastPass = entry.pass;
+    best->pass += quantum * best->stride;
+    best->running++;
+
+    pid = entry.pid;
+    states[pid].dispatched = true;
+    return true;
+}
+
+void StrideReadyQueue::remove(const process &proc)
+{
+    auto it = states.find(proc.getPid());
+    if (it == states.end())
+        return;
+    settle(it->second, proc.getCurrentLine());
+    states.erase(it);
+}
+
+std::vector<ReadyGroupStats> StrideReadyQueue::groupStats() const
+{
+    std::vector<ReadyGroupStats> stats;
+    for (const Group &group : groups)
+        stats.push_back({group.name, group.tickets, group.queue.size(), group.ticks});
+    return stats;
+}
+
+EdfReadyQueue::EdfReadyQueue(int numCores, int delayPerExec)
+    : numCores(numCores),
+      tick(std::chrono::milliseconds(std::max(delayPerExec, 1))),
+      epoch(Clock::now()),
+      preemption(numCores)
+{
+}
+
+std::string EdfReadyQueue::admit(const process &proc)
+{
+    int remaining = ShortestRemainingReadyQueue::remainingOf(proc);
+    if (proc.getDeadline() <= 0)
+    {
+        states[proc.getPid()] = {kNoDeadline, remaining};
+        return {};
+    }
+
+    if (remaining > proc.getDeadline())
+    {
+        rejected++;
+        return "deadline of " + std::to_string(proc.getDeadline()) + " ticks is shorter than its " +
+               std::to_string(remaining) + " instructions";
+    }
+
+    int64_t now = nowTicks();
+    double density = static_cast<double>(remaining) / proc.getDeadline();
+    for (const auto &[pid, state] : states)
+    {
+        if (state.deadline == kNoDeadline)
+            continue;
+        int64_t window = std::max<int64_t>(state.deadline - now, 1);
+        density += std::min(static_cast<double>(state.remaining) / window, 1.0);
+    }
+    if (density > numCores)
+    {
+        rejected++;
+        return "admitting it would need " + std::to_string(density) + " of " + std::to_string(numCores) + " cores";
+    }
+
+    states[proc.getPid()] = {now + proc.getDeadline(), remaining};
+    return {};
+}
+
+void EdfReadyQueue::push(const process &proc)
+{
+    // Processes that skipped admit() (none today) run as if untagged
+    auto [it, inserted] = states.try_emplace(proc.getPid(), ProcState{kNoDeadline, 0});
+    ProcState &state = it->second;
+    state.remaining = ShortestRemainingReadyQueue::remainingOf(proc);
+    heap.push({state.deadline, nextSeq++, proc.getPid()});
+    preemption.arrived(state.deadline);
+}
+
+bool EdfReadyQueue::pop(int coreId, int &pid)
+{
+    if (heap.empty())
+        return false;
+    Entry entry = heap.top();
+    heap.pop();
+    preemption.started(coreId, entry.deadline);
+    preemption.withdraw(heap.empty() ? CorePreemption::kNone : heap.top().deadline);
+    pid = entry.pid;
+    return true;
+}
+
+bool EdfReadyQueue::shouldPreempt(int coreId, const process &) const
+{
+    return preemption.requestedBy(coreId) != CorePreemption::kNone;
+}
+
+void EdfReadyQueue::remove(const process &proc)
+{
+    auto it = states.find(proc.getPid());
+    if (it == states.end())
+        return;
+    if (it->second.deadline != kNoDeadline)
+    {
+        if (nowTicks() <= it->second.deadline)
+            met++;
+        else
+            missed++;
+    }
+    states.erase(it);
+}
+
+ReadyDeadlineStats EdfReadyQueue::deadlineStats() const
+{
+    ReadyDeadlineStats stats{met, missed, rejected, 0};
+    for (const auto &[pid, state] : states)
+    {
+        if (state.deadline != kNoDeadline)
+            stats.pending++;
+    }
+    return stats;
+}
+
+std::unique_ptr<ReadyQueue> makeReadyQueue(const Config &config)
+{
+    switch (config.getSchedulerAlgorithm())
+    {
+    case SchedulerAlgorithm::RR:
+        if (config.isAdaptiveQuantum())
+            return std::make_unique<AdaptiveFifoReadyQueue>(config.getNumCPU(), config.getQuantumCycles(),
+                                                            config.getQuantumMin(), config.getQuantumMax());
+        return std::make_unique<FifoReadyQueue>(config.getNumCPU(), config.getQuantumCycles());
+    case SchedulerAlgorithm::PRIO:
+        return std::make_unique<PriorityReadyQueue>(config.getNumCPU());
+    case SchedulerAlgorithm::MLFQ:
+        return std::make_unique<MlfqReadyQueue>(config.getNumCPU(), config.getMlfqQuanta(), config.getMlfqBoostInterval());
+    case SchedulerAlgorithm::SJF:
+        return std::make_unique<ShortestRemainingReadyQueue>(config.getNumCPU(), false);
+    case SchedulerAlgorithm::SRTF:
+        return std::make_unique<ShortestRemainingReadyQueue>(config.getNumCPU(), true);
+    case SchedulerAlgorithm::STRIDE:
+        return std::make_unique<StrideReadyQueue>(config.getQuantumCycles(), config.getDefaultTickets(), config.getGroupTickets());
+    case SchedulerAlgorithm::EDF:
+        return std::make_unique<EdfReadyQueue>(config.getNumCPU(), config.getDelaysPerExec());
+    default:
+        return std::make_unique<FifoReadyQueue>(config.getNumCPU(), 0);
+    }
+}
@@ -0,0 +1,475 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <climits>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "myProcess.h"
+#include "Config.h"
+
+// Depth and queueing delay of one ready-queue level, for vmstat
+struct ReadyLevelStats
+{
+    int level;
+    int quantum;
+    size_t depth;
+    uint64_t dispatched;
+    double avgWaitMs;
+};
+
+// CPU consumed by one share group, for vmstat
+struct ReadyGroupStats
+{
+    std::string name;
+    int tickets;
+    size_t depth;
+    uint64_t ticks;
+};
+
+// Outcome of deadline-tagged processes under EDF, for vmstat
+struct ReadyDeadlineStats
+{
+    uint64_t met = 0;
+    uint64_t missed = 0;
+    uint64_t rejected = 0;
+    size_t pending = 0; // admitted and not finished yet
+};
+
+// Thrown by Scheduler::addProcess when the ready queue's admission control
+// turns a process away; nothing has been queued at that point
+struct AdmissionRejected : std::runtime_error
+{
+    int pid;
+    AdmissionRejected(int pid, const std::string &reason)
+        : std::runtime_error(reason), pid(pid) {}
+};
+
+// Decides which process a core runs next and for how long. The scheduler
+// owns one ReadyQueue, picked from the configured algorithm, and calls
+// push/pop/release/remove under its queue mutex. sliceLength and
+// shouldPreempt are called by the running worker without that lock.
+class ReadyQueue
+{
+public:
+    virtual ~ReadyQueue() = default;
+
+    // Called once per process before its first push; a non-empty reason rejects it
+    virtual std::string admit(const process &) { return {}; }
+    virtual void push(const process &proc) = 0;
+    virtual bool pop(int coreId, int &pid) = 0;
+    virtual size_t size() const = 0;
+    bool empty() const { return size() == 0; }
+    // Whether pop(coreId) would return something; differs from !empty()
+    // only when processes are pinned to other cores
+    virtual bool hasWork(int) const { return !empty(); }
+
+    // Instructions the process just popped by coreId may run; 0 runs it to completion
+    virtual int sliceLength(int, const process &) const { return 0; }
+    virtual bool shouldPreempt(int, const process &) const { return false; }
+    // The core is done with the process it last popped
+    virtual void release(int) {}
+    // The process has finished; settle and drop any per-process bookkeeping
+    virtual void remove(const process &) {}
+
+    virtual std::vector<ReadyLevelStats> levelStats() const { return {}; }
+    virtual std::vector<ReadyGroupStats> groupStats() const { return {}; }
+    virtual ReadyDeadlineStats deadlineStats() const { return {}; }
+};
+
+// FCFS (quantum 0) and RR: one shared FIFO with soft affinity. A core
+// takes the oldest process it may run, unless that process last ran
+// elsewhere and one of the next kAffinityWindow entries last ran on this
+// core; the skipped entry is never passed over more than kMaxSkips times.
+// Processes pinned to a core are only ever popped by that core.
+class FifoReadyQueue : public ReadyQueue
+{
+public:
+    static constexpr size_t kAffinityWindow = 8;
+    static constexpr int kMaxSkips = 4;
+
+    FifoReadyQueue(int numCores, int quantum) : quantum(quantum), pinnedCount(numCores, 0) {}
+
+    void push(const process &proc) override;
+    bool pop(int coreId, int &pid) override;
+    size_t size() const override { return queue.size(); }
+    bool hasWork(int coreId) const override { return unpinnedCount > 0 || pinnedCount[coreId] > 0; }
+    int sliceLength(int, const process &) const override { return quantum; }
+
+private:
+    struct Entry
+    {
+        int pid;
+        int lastCore;
+        int pinnedCore;
+        int skips;
+    };
+
+    std::deque<Entry> queue;
+    int quantum;
+    size_t unpinnedCount = 0;
+    std::vector<size_t> pinnedCount; // per core
+
+    void take(size_t index, int &pid);
+};
+
+// Round robin whose slice is sized per process. Each process keeps an
+// estimate of its CPU burst: an exponential average of how many
+// instructions it ran before stopping on its own (a SLEEP, a page fault or
+// completion), counting a slice it used up as twice its length since it
+// wanted more. New processes start from the average over all processes.
+// The slice is 1.25x the estimate, within [minQuantum, maxQuantum], and the
+// upper bound shrinks as the queue grows past one waiting process per core,
+// so a full round of the queue stays near one maxQuantum. A SLEEP ends the
+// dispatch it ran in.
+class AdaptiveFifoReadyQueue : public FifoReadyQueue
+{
+public:
+    AdaptiveFifoReadyQueue(int numCores, int initialQuantum, int minQuantum, int maxQuantum);
+
+    void push(const process &proc) override;
+    bool pop(int coreId, int &pid) override;
+    int sliceLength(int coreId, const process &) const override { return runningSlice[coreId]; }
+    bool shouldPreempt(int, const process &proc) const override { return proc.isSleeping(); }
+    void remove(const process &proc) override;
+
+private:
+    struct ProcState
+    {
+        double burst;
+        int lastLine;
+        int slice = 0; // granted at the last pop, 0 while queued
+    };
+
+    int numCores;
+    int minQuantum;
+    int maxQuantum;
+    double averageBurst;
+    std::unordered_map<int, ProcState> states;
+    std::vector<int> runningSlice; // per core, written by pop on that core's thread
+
+    void observe(ProcState &state, double ran);
+};
+
+// Preemptive priority. Every core has kLevels FIFO buckets and a bitmap of
+// the non-empty ones, so push and pop are O(1) plus a scan over cores. A new
+// process goes to the core running the least important work, and that core
+// is preempted at its next instruction if the newcomer outranks it. Idle
+// cores steal the most important waiting process from other cores.
+//
+// Aging: every kAgingInterval pops, the oldest entry of each non-empty
+// bucket below the top moves up one level, so low priorities still run under
+// a steady stream of high-priority work. A process re-enters at its own
+// priority after it runs.
+class PriorityReadyQueue : public ReadyQueue
+{
+public:
+    static constexpr int kLevels = 32; // priorities 0 (lowest) .. 31
+    static constexpr int kAgingInterval = 16;
+
+    explicit PriorityReadyQueue(int numCores);
+
+    static int levelOf(int priority);
+
+    void push(const process &proc) override;
+    bool pop(int coreId, int &pid) override;
+    size_t size() const override { return total; }
+    bool shouldPreempt(int coreId, const process &proc) const override;
+    void release(int coreId) override { cores[coreId].runningLevel = -1; }
+
+private:
+    struct CoreQueue
+    {
+        std::array<std::deque<int>, kLevels> buckets;
+        uint32_t nonEmpty = 0; // bit l set while buckets[l] has entries
+        size_t count = 0;
+        int runningLevel = -1; // -1 while idle
+        std::atomic<int> topLevel{-1};
+    };
+
+    int numCores;
+    std::unique_ptr<CoreQueue[]> cores;
+    size_t total = 0;
+    int popsSinceAging = 0;
+
+    static int highest(const CoreQueue &core);
+    void add(CoreQueue &core, int level, int pid);
+    int take(CoreQueue &core, int level);
+    void age();
+};
+
+// Preemption requests for the policies whose cores share one queue. Work
+// is ranked by a non-negative key, lower running first. Each arrival that
+// outranks running work asks at most one core to yield: none while a core
+// is idle, since that core takes the arrival, otherwise the core running
+// the worst-ranked work that has not been asked already. A process that
+// yielded is re-queued while its own core is idle, so it waits for a free
+// core instead of pushing out another and one arrival never cascades. A
+// core's request is dropped once it pops or releases, or once another core
+// has taken the work that outranked it. Everything but requestedBy() runs under the
+// scheduler's queue mutex; the running worker polls requestedBy().
+class CorePreemption
+{
+public:
+    static constexpr int64_t kNone = INT64_MAX;
+
+    explicit CorePreemption(int numCores);
+
+    void started(int coreId, int64_t key);
+    void stopped(int coreId);
+    void arrived(int64_t key);
+    // After a pop: bestWaiting is the best key still queued (kNone if empty)
+    void withdraw(int64_t bestWaiting);
+    // Running work is re-ranked to at most key; pending requests lapse
+    void promoteAll(int64_t key);
+    // Key of the arrival this core should yield to, kNone if none
+    int64_t requestedBy(int coreId) const { return requests[coreId].load(std::memory_order_relaxed); }
+
+private:
+    static constexpr int64_t kIdle = -1;
+
+    std::vector<int64_t> running; // per core, kIdle while idle
+    std::unique_ptr<std::atomic<int64_t>[]> requests;
+};
+
+// Multi-level feedback queue. New processes start at level 0 (most
+// important). Each level has its own quantum, and a process is demoted one
+// level once it has used up that level's quantum in total, so it gains
+// nothing by giving up the core just before its slice ends. A process
+// arriving above a running level preempts one core, the one running the
+// lowest level (see CorePreemption). Every boostInterval dispatches all
+// processes move back to level 0, so long batch jobs still run under a
+// stream of short ones.
+class MlfqReadyQueue : public ReadyQueue
+{
+public:
+    MlfqReadyQueue(int numCores, std::vector<int> quanta, int boostInterval);
+
+    void push(const process &proc) override;
+    bool pop(int coreId, int &pid) override;
+    size_t size() const override { return total; }
+    int sliceLength(int coreId, const process &) const override { return running[coreId].slice; }
+    bool shouldPreempt(int coreId, const process &proc) const override;
+    void release(int coreId) override { preemption.stopped(coreId); }
+    void remove(const process &proc) override { states.erase(proc.getPid()); }
+    std::vector<ReadyLevelStats> levelStats() const override;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Waiting
+    {
+        int pid;
+        Clock::time_point since;
+    };
+    struct Level
+    {
+        std::deque<Waiting> queue;
+        uint64_t dispatched = 0;
+        Clock::duration totalWait{};
+    };
+    struct ProcState
+    {
+        int level = 0;
+        int used = 0;     // instructions run at this level
+        int lastLine = 0; // current line when last queued
+    };
+    struct Running
+    {
+        int level = 0;
+        int slice = 0;
+    };
+
+    std::vector<int> quanta;
+    std::vector<Level> levels;
+    std::unordered_map<int, ProcState> states;
+    std::vector<Running> running; // per core, written by pop on that core's thread
+    CorePreemption preemption;    // keyed on level
+    int topLevel;                 // most important non-empty level, levels.size() when empty
+    size_t total = 0;
+    int boostInterval;
+    int popsSinceBoost = 0;
+
+    void updateTopLevel();
+    void boost();
+};
+
+// Shortest job first on the remaining instruction count. The count is
+// computed once when a process is queued and cached in its heap entry, so
+// ordering is O(log n) per push/pop. SJF runs each dispatch to completion;
+// SRTF: a process arriving with strictly fewer instructions left than
+// running ones preempts one core, the one with the most left (see
+// CorePreemption). Ties go to the earlier arrival.
+class ShortestRemainingReadyQueue : public ReadyQueue
+{
+public:
+    ShortestRemainingReadyQueue(int numCores, bool preemptive) : preemption(numCores), preemptive(preemptive) {}
+
+    static int remainingOf(const process &proc) { return proc.getLineCount() - proc.getCurrentLine(); }
+
+    void push(const process &proc) override;
+    bool pop(int coreId, int &pid) override;
+    size_t size() const override { return heap.size(); }
+    bool shouldPreempt(int coreId, const process &proc) const override;
+    void release(int coreId) override { preemption.stopped(coreId); }
+
+private:
+    struct Entry
+    {
+        int remaining;
+        uint64_t seq;
+        int pid;
+        bool operator>(const Entry &other) const
+        {
+            return remaining != other.remaining ? remaining > other.remaining : seq > other.seq;
+        }
+    };
+
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+    uint64_t nextSeq = 0;
+    CorePreemption preemption; // keyed on remaining count at pop
+    bool preemptive;
+};
+
+// Two-level stride scheduling. CPU is first split between groups (tenants)
+// in proportion to their tickets, then between the processes of a group in
+// proportion to theirs, so a tenant's share does not grow with the number
+// of processes it spawns. Each group and process has a pass value that
+// advances by stride = kStride1 / tickets per instruction run; pop takes the
+// group with the lowest pass and, from its heap, the process with the
+// lowest pass.
+//
+// A group is charged a full quantum when one of its processes is
+// dispatched and refunded what went unused when it comes back, so several
+// cores do not all pick the same group before any of them has run. A group
+// or process that was idle rejoins at the current pass rather than with
+// the credit it would have built up while away.
+class StrideReadyQueue : public ReadyQueue
+{
+public:
+    static constexpr uint64_t kStride1 = 1 << 20;
+
+    StrideReadyQueue(int quantum, int defaultTickets, const std::vector<std::pair<std::string, int>> &groupTickets);
+
+    void push(const process &proc) override;
+    bool pop(int coreId, int &pid) override;
+    size_t size() const override { return total; }
+    int sliceLength(int, const process &) const override { return quantum; }
+    void remove(const process &proc) override;
+    std::vector<ReadyGroupStats> groupStats() const override;
+
+private:
+    struct Waiting
+    {
+        uint64_t pass;
+        uint64_t seq;
+        int pid;
+        bool operator>(const Waiting &other) const
+        {
+            return pass != other.pass ? pass > other.pass : seq > other.seq;
+        }
+    };
+    struct Group
+    {
+        std::string name;
+        int tickets;
+        uint64_t stride;
+        uint64_t pass = 0;
+        uint64_t lastPass = 0; // pass of the last process dispatched from this group
+        std::priority_queue<Waiting, std::vector<Waiting>, std::greater<Waiting>> queue;
+        int running = 0;
+        uint64_t ticks = 0;
+    };
+    struct ProcState
+    {
+        int group;
+        uint64_t stride;
+        uint64_t pass;
+        int lastLine;
+        bool dispatched = false;
+    };
+
+    void settle(ProcState &state, int line);
+
+    int quantum;
+    int defaultTickets;
+    std::vector<Group> groups; // few, so pop scans them
+    std::unordered_map<std::string, int> groupIndex;
+    std::unordered_map<int, ProcState> states;
+    uint64_t globalPass = 0; // group pass at the last dispatch
+    uint64_t nextSeq = 0;
+    size_t total = 0;
+
+    int groupFor(const std::string &name);
+};
+
+// Earliest deadline first. A process's deadline is given in ticks from its
+// admission, one tick being delay-per-exec milliseconds (at least 1), the
+// same unit as page-fault-latency. Processes without a deadline run only
+// when no deadline-tagged process is waiting, in arrival order. A process
+// arriving with an earlier deadline than running ones preempts one core,
+// the one with the latest deadline (see CorePreemption).
+//
+// Admission: each unfinished deadline process needs remaining / (deadline -
+// now) of a core, its density. A newcomer is rejected if it could not
+// finish even alone, or if it would push the total density of admitted
+// processes past the number of cores. Remaining counts are those cached
+// when each process was last queued.
+class EdfReadyQueue : public ReadyQueue
+{
+public:
+    static constexpr int64_t kNoDeadline = INT64_MAX;
+
+    EdfReadyQueue(int numCores, int delayPerExec);
+
+    std::string admit(const process &proc) override;
+    void push(const process &proc) override;
+    bool pop(int coreId, int &pid) override;
+    size_t size() const override { return heap.size(); }
+    bool shouldPreempt(int coreId, const process &proc) const override;
+    void release(int coreId) override { preemption.stopped(coreId); }
+    void remove(const process &proc) override;
+    ReadyDeadlineStats deadlineStats() const override;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry
+    {
+        int64_t deadline;
+        uint64_t seq;
+        int pid;
+        bool operator>(const Entry &other) const
+        {
+            return deadline != other.deadline ? deadline > other.deadline : seq > other.seq;
+        }
+    };
+    struct ProcState
+    {
+        int64_t deadline; // absolute tick, kNoDeadline if none
+        int remaining;
+    };
+
+    int numCores;
+    Clock::duration tick;
+    Clock::time_point epoch;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+    std::unordered_map<int, ProcState> states;
+    CorePreemption preemption; // keyed on deadline
+    uint64_t nextSeq = 0;
+    uint64_t met = 0;
+    uint64_t missed = 0;
+    uint64_t rejected = 0;
+
+    int64_t nowTicks() const { return (Clock::now() - epoch) / tick; }
+};
+
+std::unique_ptr<ReadyQueue> makeReadyQueue(const Config &config);
@@ -12,6 +12,8 @@
 #include <fstream>
 #include <iomanip>
 #include <ctime>
+#include <cmath>
+#include <algorithm>
 #include <sys/stat.h>
 #ifdef _WIN32
 #include <direct.h>
@@ -22,39 +24,135 @@
 using namespace std;
 
 Scheduler::Scheduler(ProcessList &plist, Config &config, MemoryManager &memManager)
-    : processList(plist),
-      numCores(config.getNumCPU()),
-      running(false),
-      batchFreq(config.getBatchProcessFreq()),
+    : batchFreq(config.getBatchProcessFreq()),
       minIns(config.getMinIns()),
       maxIns(config.getMaxIns()),
       delaysPerExec(config.getDelaysPerExec()),
-      schedulerType(config.getSchedulerAlgorithm()),
       quantum(config.getQuantumCycles()),
-      memoryManager(memManager),
+      numCores(config.getNumCPU()),
       minMemPerProc(config.getMinMemPerProc()),
       maxMemPerProc(config.getMaxMemPerProc()),
-      coreAssignments(config.getNumCPU(), -1)
+      batchDeadline(config.getBatchDeadline()),
+      migrationCost(config.getMigrationCost()),
+      placement(config),
+      memoryStampWriter("memory_stamp/memory_stamp.bin", memManager.getFrameSize(), config.getMinMemPerProc()),
+      schedulerType(config.getSchedulerAlgorithm()),
+      processList(plist),
+      memoryManager(memManager),
+      readyQueue(makeReadyQueue(config)),
+      idleCores(new IdleCore[config.getNumCPU()]),
+      running(false),
+      coreAssignments(config.getNumCPU(), -1),
+      pageFaultLatency(config.getPageFaultLatency())
 {
+    memoryManager.setDeferPageFaults(pageFaultLatency > 0);
+    srand(config.getRandomSeed());
 }
 
 void Scheduler::start()
 {
+    struct stat st = {0};
+    if (stat("memory_stamp", &st) == -1)
+    {
+        mkdir("memory_stamp", 0755);
+    }
+    memoryStampWriter.start([this](std::thread &thread)
+                            { pinHousekeeping(thread); });
+
     running = true;
     for (int i = 0; i < numCores; ++i)
+    {
         workers.emplace_back(&Scheduler::workerThreadFunc, this, i);
-    schedulerThread = std::thread(&Scheduler::schedulerThreadFunc, this);
+        int cpu = placement.workerCpu(i);
+        if (cpu >= 0)
+            pinThread(workers.back(), {cpu});
+    }
+    if (pageFaultLatency > 0)
+    {
+        pagerThread = std::thread(&Scheduler::pagerThreadFunc, this);
+        pinThread(pagerThread, placement.getHousekeepingCpus());
+    }
+}
+
+void Scheduler::pinThread(std::thread &thread, const std::vector<int> &cpus)
+{
+    if (!HostPlacement::pin(thread, cpus))
+    {
+        std::cerr << "[ERROR] Could not pin a thread to CPU";
+        for (size_t i = 0; i < cpus.size(); ++i)
+            std::cerr << (i ? "," : " ") << cpus[i];
+        std::cerr << std::endl;
+    }
 }
 
 void Scheduler::stop()
 {
     running = false;
-    cv.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        for (int i = 0; i < numCores; ++i)
+            idleCores[i].cv.notify_one();
+    }
+    pagerCv.notify_all();
     for (auto &t : workers)
         if (t.joinable())
             t.join();
-    if (schedulerThread.joinable())
-        schedulerThread.join();
+    if (pagerThread.joinable())
+        pagerThread.join();
+    memoryStampWriter.stop();
+}
+
+void Scheduler::requestPage(int pid, int pageNum)
+{
+    // One cycle is one delay-per-exec interval, but never less than 1 ms
+    auto latency = std::chrono::milliseconds(static_cast<long long>(pageFaultLatency) * std::max(delaysPerExec, 1));
+    {
+        std::lock_guard<std::mutex> lock(pagerMutex);
+        pendingFaults.push({std::chrono::steady_clock::now() + latency, pid, pageNum});
+    }
+    pagerCv.notify_one();
+}
+
+void Scheduler::pagerThreadFunc()
+{
+    std::unique_lock<std::mutex> lock(pagerMutex);
+    while (running)
+    {
+        if (pendingFaults.empty())
+        {
+            pagerCv.wait(lock, [this]
+                         { return !pendingFaults.empty() || !running; });
+            continue;
+        }
+
+        PendingFault fault = pendingFaults.top();
+        if (std::chrono::steady_clock::now() < fault.readyAt)
+        {
+            pagerCv.wait_until(lock, fault.readyAt);
+            continue;
+        }
+        pendingFaults.pop();
+        lock.unlock();
+
+        try
+        {
+            memoryManager.servicePageFault(fault.pid, fault.pageNum);
+            processList.withProcessByRef(fault.pid, [&](process &proc)
+                                         {
+                proc.setState(ProcessState::READY);
+                std::lock_guard<std::mutex> queueLock(queueMutex);
+                enqueueLocked(proc); });
+        }
+        catch (const std::exception &ex)
+        {
+            std::cerr << "[ERROR] Exception in pager thread: " << ex.what() << std::endl;
+            processList.withProcessByRef(fault.pid, [](process &proc)
+                                         { proc.setState(ProcessState::FINISHED); });
+            retireProcess(fault.pid);
+        }
+
+        lock.lock();
+    }
 }
 
 void Scheduler::addProcess(const process &proc)
@@ -74,9 +172,110 @@ void Scheduler::addProcess(const process &proc)
 
     {
         std::lock_guard<std::mutex> lock(queueMutex);
-        readyQueue.push(proc.getPid());
+        std::string reason = readyQueue->admit(proc);
+        if (!reason.empty())
+            throw AdmissionRejected(proc.getPid(), "Process rejected: " + reason);
+        arrivals.emplace(proc.getPid(), std::chrono::steady_clock::now());
+        enqueueLocked(proc);
+    }
+}
+
+// Queues a process and wakes one parked core that may run it. Cores that
+// are still spinning notice the queued count on their own.
+void Scheduler::enqueueLocked(const process &proc)
+{
+    readyQueue->push(proc);
+    queuedCount.store(readyQueue->size(), std::memory_order_relaxed);
+
+    int preferred = proc.getPinnedCore() >= 0 ? proc.getPinnedCore() : proc.getCoreId();
+    for (int i = 0; i < numCores; ++i)
+    {
+        int core = (std::max(preferred, 0) + i) % numCores;
+        IdleCore &idle = idleCores[core];
+        if (idle.parked && readyQueue->hasWork(core))
+        {
+            idle.parked = false;
+            idle.cv.notify_one();
+            return;
+        }
     }
-    cv.notify_one();
+}
+
+// Idle path of a worker. It first spins on the queued count for up to its
+// spin budget, which doubles when work shows up while spinning and halves
+// when it does not, then parks on its own condition variable until
+// enqueueLocked picks it. The time spent here is what idle ticks measure.
+// Returns false once the scheduler stops.
+bool Scheduler::waitForWork(int coreId, int &pid)
+{
+    IdleCore &idle = idleCores[coreId];
+    std::unique_lock<std::mutex> lock(queueMutex);
+
+    auto tryPop = [&]
+    {
+        if (!readyQueue->hasWork(coreId) || !readyQueue->pop(coreId, pid))
+            return false;
+        queuedCount.store(readyQueue->size(), std::memory_order_relaxed);
+        return true;
+    };
+    if (tryPop())
+        return true;
+
+    auto idleStart = std::chrono::steady_clock::now();
+    idle.since.store(idleStart.time_since_epoch().count(), std::memory_order_relaxed);
+    bool found = false;
+    while (running && !found)
+    {
+        lock.unlock();
+        bool seen = false;
+        for (int i = 0; i < idle.spinBudget && running; ++i)
+        {
+            if (queuedCount.load(std::memory_order_relaxed) > 0)
+            {
+                seen = true;
+                break;
+            }
+            std::this_thread::yield();
+        }
+        lock.lock();
+
+        if (tryPop())
+        {
+            found = true;
+            if (seen)
+                idle.spinBudget = std::min(idle.spinBudget * 2, IdleCore::kMaxSpin);
+            break;
+        }
+        idle.spinBudget = std::max(idle.spinBudget / 2, IdleCore::kMinSpin);
+
+        idle.parked = true;
+        idle.cv.wait(lock, [&]
+                     { return !idle.parked || !running; });
+        idle.parked = false;
+        found = tryPop();
+    }
+
+    idle.since.store(0, std::memory_order_relaxed);
+    idleNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - idleStart).count(),
+                        std::memory_order_relaxed);
+    return found;
+}
+
+uint64_t Scheduler::getIdleTicks() const
+{
+    int64_t total = static_cast<int64_t>(idleNanos.load(std::memory_order_relaxed));
+    int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+    for (int i = 0; i < numCores; ++i)
+    {
+        int64_t since = idleCores[i].since.load(std::memory_order_relaxed);
+        if (since != 0)
+            total += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::duration(now - since))
+                         .count();
+    }
+    auto tick = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::milliseconds(std::max(delaysPerExec, 1)));
+    return static_cast<uint64_t>(total / tick.count());
 }
 
 void Scheduler::generateInstructionsForProcess(int pid)
@@ -128,15 +327,6 @@ void Scheduler::generateInstructionsForProcess(int pid)
         } });
 }
 
-void Scheduler::schedulerThreadFunc()
-{
-    while (running)
-    {
-        std::this_thread::sleep_for(std::chrono::milliseconds(delaysPerExec));
-        cv.notify_all();
-    }
-}
-
 std::shared_ptr<Command> Scheduler::generateForBlock(int currentDepth, const std::string &procName)
 {
     std::vector<std::shared_ptr<Command>> nestedInstructions;
@@ -157,23 +347,15 @@ void Scheduler::workerThreadFunc(int coreId)
     while (running)
     {
         int pid = -1;
-        {
-            std::unique_lock<std::mutex> lock(queueMutex);
-            if (readyQueue.empty())
-            {
-                idleTicks++;
-            }
-            cv.wait(lock, [this]
-                    { return !readyQueue.empty() || !running; });
-            if (!running)
-                break;
-            pid = readyQueue.front();
-            readyQueue.pop();
-        }
+        int ran = 0; // instructions completed in this dispatch
+        if (!waitForWork(coreId, pid))
+            break;
 
         try
         {
-            process &proc = processList.findProcessByRef(pid);
+            // Pinned for the dispatch, so retiring it below cannot free it under us
+            std::shared_ptr<process> pinned = processList.findProcess(pid);
+            process &proc = *pinned;
             int requiredMemory = proc.getMemorySize();
 
             if (!memoryManager.isAllocated(proc.getPid()))
@@ -185,172 +367,164 @@ void Scheduler::workerThreadFunc(int coreId)
                     std::this_thread::sleep_for(std::chrono::milliseconds(100));
                     {
                         std::lock_guard<std::mutex> lock(queueMutex);
-                        readyQueue.push(proc.getPid());
+                        readyQueue->release(coreId);
+                        enqueueLocked(proc);
                     }
-                    cv.notify_one();
                     continue;
                 }
                 proc.setMemoryManager(&memoryManager);
             }
 
-            proc.setState(ProcessState::RUNNING);
-            coreAssignments[coreId] = proc.getPid();
-
-            if (schedulerType == SchedulerAlgorithm::FCFS)
+            // A process resumed on another core pays migrationCost ticks
+            // for its cold cache before it makes progress
+            if (proc.dispatch(coreId))
             {
-                for (int i = proc.getCurrentLine(); i < proc.getLineCount(); ++i)
+                migrations.fetch_add(1, std::memory_order_relaxed);
+                for (int i = 0; i < migrationCost; ++i)
                 {
-                    activeTicks++;
-                    auto instruction = proc.getCurrentInstruction();
-                    if (instruction)
-                    {
-                        instruction->execute(proc);
-                    }
-                    proc.setCurrentLine(i + 1);
+                    activeTicks.fetch_add(1, std::memory_order_relaxed);
                     std::this_thread::sleep_for(std::chrono::milliseconds(delaysPerExec));
                 }
-                proc.setState(ProcessState::FINISHED);
-                memoryManager.free(proc.getPid());
             }
 
-            else if (schedulerType == SchedulerAlgorithm::RR)
+            coreAssignments[coreId] = proc.getPid();
+            busyCores++;
+
+            // The ready queue decides the slice length (0: run to completion)
+            // and whether a waiting process should take this core over
+            // A SLEEP only marks the dispatch it ran in
+            proc.setSleeping(false);
+            int slice = readyQueue->sliceLength(coreId, proc);
+            int endLine = proc.getLineCount();
+            if (slice > 0)
+                endLine = std::min(endLine, proc.getCurrentLine() + slice);
+
+            for (int i = proc.getCurrentLine(); i < endLine; ++i)
             {
-                int startLine = proc.getCurrentLine();
-                int endLine = startLine + quantum;
-                if (endLine > proc.getLineCount())
-                    endLine = proc.getLineCount();
-
-                for (int i = startLine; i < endLine; ++i)
+                activeTicks.fetch_add(1, std::memory_order_relaxed);
+                auto instruction = proc.getCurrentInstruction();
+                if (instruction)
                 {
-                    activeTicks++;
-                    auto instruction = proc.getCurrentInstruction();
-                    if (instruction)
-                    {
-                        instruction->execute(proc);
-                    }
-                    proc.setCurrentLine(i + 1);
-                    std::this_thread::sleep_for(std::chrono::milliseconds(delaysPerExec));
-                }
-
-                if (proc.getCurrentLine() >= proc.getLineCount())
-                {
-                    proc.setState(ProcessState::FINISHED);
-                    memoryManager.free(proc.getPid());
-                }
-                else
-                {
-                    proc.setState(ProcessState::READY);
-                    {
-                        std::lock_guard<std::mutex> lock(queueMutex);
-                        readyQueue.push(proc.getPid());
-                    }
-                    cv.notify_one();
+                    instruction->execute(proc);
                 }
+                proc.setCurrentLine(i + 1);
+                ran++;
+                std::this_thread::sleep_for(std::chrono::milliseconds(delaysPerExec));
+                if (readyQueue->shouldPreempt(coreId, proc))
+                    break;
             }
 
+            if (proc.getCurrentLine() >= proc.getLineCount())
+            {
+                proc.setState(ProcessState::FINISHED);
+                retireProcess(pid); // proc is archived after this
+            }
             else
             {
                 proc.setState(ProcessState::READY);
                 {
                     std::lock_guard<std::mutex> lock(queueMutex);
-                    readyQueue.push(proc.getPid());
+                    readyQueue->release(coreId);
+                    enqueueLocked(proc);
                 }
-                cv.notify_one();
             }
+
+            if (slice > 0)
+                snapshotMemory(quantumCycle++);
         }
 
+        catch (const PageFault &fault)
+        {
+            // The instruction did not complete; it is retried once the page is in
+            processList.withProcessByRef(pid, [](process &proc)
+                                         { proc.setState(ProcessState::BLOCKED); });
+            requestPage(fault.pid, fault.pageNum);
+        }
         catch (const std::exception &ex)
         {
+            // e.g. a memory access violation: the process cannot continue, so retire it
             std::cerr << "[ERROR] Exception in worker thread (run): " << ex.what() << std::endl;
-            continue;
+            processList.withProcessByRef(pid, [](process &proc)
+                                         { proc.setState(ProcessState::FINISHED); });
+            retireProcess(pid);
         }
         {
             std::lock_guard<std::mutex> lock(queueMutex);
+            readyQueue->release(coreId);
+            if (coreAssignments[coreId] != -1)
+            {
+                busyCores--;
+                contextSwitches.fetch_add(1, std::memory_order_relaxed);
+                dispatchedInstructions.fetch_add(ran, std::memory_order_relaxed);
+            }
             coreAssignments[coreId] = -1;
         }
     }
 }
 
-void Scheduler::snapshotMemory(int cycle)
+// Frees a finished process's memory and moves it to the archive
+void Scheduler::retireProcess(int pid)
 {
-    static std::mutex snapshotMutex;
-    std::lock_guard<std::mutex> lock(snapshotMutex);
-
-    auto now = std::chrono::system_clock::now();
-    std::time_t now_c = std::chrono::system_clock::to_time_t(now);
-    std::tm *now_tm = std::localtime(&now_c);
-    char timebuf[64];
-    std::strftime(timebuf, sizeof(timebuf), "%m/%d/%Y %I:%M:%S%p", now_tm);
-
-    int frameSize = memoryManager.getFrameSize();
-
-    auto blocks = memoryManager.getBlocksSnapshot();
-    int procCount = 0;
-    for (const auto &block : blocks)
-    {
-        if (block.ownerPid != -1)
-            procCount++;
-    }
-
-    int extFrag = 0;
-    for (const auto &block : blocks)
+    memoryManager.free(pid);
+    processList.withProcessByRef(pid, [&](process &proc)
+                                 {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        readyQueue->remove(proc); });
     {
-        if (block.ownerPid == -1 && frameSize > 0 && (block.numFrames * frameSize) < minMemPerProc)
+        std::lock_guard<std::mutex> lock(queueMutex);
+        auto arrival = arrivals.find(pid);
+        if (arrival != arrivals.end())
         {
-            extFrag += block.numFrames * frameSize;
+            totalTurnaround += std::chrono::steady_clock::now() - arrival->second;
+            finishedCount++;
+            arrivals.erase(arrival);
         }
     }
+    processList.archiveProcess(pid);
+}
 
-    std::vector<std::string> memLines;
-    int upper = 0;
-    if (!blocks.empty() && frameSize > 0)
-    {
-        const auto &lastBlock = blocks.back();
-        upper = lastBlock.startFrame * frameSize + lastBlock.numFrames * frameSize;
-    }
-    memLines.push_back("----end---- = " + std::to_string(upper));
+std::vector<ReadyGroupStats> Scheduler::getReadyGroupStats()
+{
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return readyQueue->groupStats();
+}
 
-    for (auto it = blocks.rbegin(); it != blocks.rend(); ++it)
-    {
-        const auto &block = *it;
-        int blockUpper = 0, blockLower = 0;
-        if (frameSize > 0)
-        {
-            blockUpper = block.startFrame * frameSize + block.numFrames * frameSize;
-            blockLower = block.startFrame * frameSize;
-        }
-        memLines.push_back(std::to_string(blockUpper));
-        if (block.ownerPid == -1)
-        {
-            memLines.push_back("FREE");
-        }
-        else
-        {
-            memLines.push_back("P" + std::to_string(block.ownerPid));
-        }
-        memLines.push_back(std::to_string(blockLower));
-        memLines.push_back("");
-    }
-    memLines.push_back("----start---- = 0");
+ReadyDeadlineStats Scheduler::getReadyDeadlineStats()
+{
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return readyQueue->deadlineStats();
+}
 
-    struct stat st = {0};
-    if (stat("memory_stamp", &st) == -1)
-    {
-        mkdir("memory_stamp", 0755);
-    }
+Scheduler::TurnaroundStats Scheduler::getTurnaroundStats()
+{
+    std::lock_guard<std::mutex> lock(queueMutex);
+    double meanMs = 0.0;
+    if (finishedCount > 0)
+        meanMs = std::chrono::duration<double, std::milli>(totalTurnaround).count() / finishedCount;
+    return {finishedCount, meanMs};
+}
 
-    std::string filename = "memory_stamp/memory_stamp_" + std::to_string(cycle) + ".txt";
-    std::ofstream out(filename);
-    out << "Timestamp: (" << timebuf << ")\n";
-    out << "Number of processes in memory: " << procCount << "\n";
-    out << "Total external fragmentation in KB: " << (extFrag / 1024) << "\n\n";
+std::vector<ReadyLevelStats> Scheduler::getReadyLevelStats()
+{
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return readyQueue->levelStats();
+}
 
-    for (const auto &line : memLines)
+void Scheduler::snapshotMemory(int cycle)
+{
+    static std::mutex snapshotMutex;
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+
+    // Formatting and file I/O happen on the stamp writer thread; the layout is
+    // only copied when an allocate/free happened since the last stamp.
+    uint64_t version = memoryManager.getLayoutVersion();
+    if (version == lastStampVersion)
     {
-        out << line << "\n";
+        memoryStampWriter.record(cycle, {}, true);
+        return;
     }
-
-    out.close();
+    lastStampVersion = version;
+    memoryStampWriter.record(cycle, memoryManager.getBlocksSnapshot(), false);
 }
 
 int countInstructions(const std::shared_ptr<Command> &cmd)
@@ -380,13 +554,8 @@ void Scheduler::startBatchGeneration()
                 int insCount = minIns + rand() % (maxIns - minIns + 1);
                 std::string procName = "Process" + std::to_string(++processCounter);
 
-                processList.addNewProcess(-1, 0, procName);
-                int pid = processList.findProcessByName(procName);
-
-                if (pid == -1) {
-                    std::cerr << "[ERROR] Failed to find process by name: " << procName << std::endl;
-                    continue;
-                }
+                ProcessHandle handle = processList.addNewProcess(-1, 0, procName);
+                int pid = handle.pid();
 
                 std::vector<std::shared_ptr<Command>> cmds;
 
@@ -469,6 +638,7 @@ void Scheduler::startBatchGeneration()
                     }
 
                     proc.setMemorySize(memSize);
+                    proc.setDeadline(batchDeadline);
                     proc.clearInstructions();
                     for (const auto &cmd : cmds) {
                         proc.addInstruction(cmd);
@@ -477,8 +647,15 @@ void Scheduler::startBatchGeneration()
 
                 try
                 {
-                    process &procRef = processList.findProcessByRef(pid);
-                    addProcess(procRef);
+                    std::shared_ptr<process> procPtr = processList.get(handle);
+                    if (!procPtr)
+                        throw std::runtime_error("Process not found");
+                    addProcess(*procPtr);
+                }
+                catch (const AdmissionRejected &)
+                {
+                    // Counted by the ready queue and shown in vmstat
+                    processList.removeProcess(pid);
                 }
                 catch (const std::exception &e)
                 {
@@ -494,6 +671,7 @@ void Scheduler::startBatchGeneration()
                 std::this_thread::sleep_for(std::chrono::milliseconds(1000));
             }
         } });
+    pinThread(batchGeneratorThread, placement.getHousekeepingCpus());
 }
 
 void Scheduler::stopBatchGeneration()
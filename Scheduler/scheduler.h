@@ -10,8 +10,13 @@
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <chrono>
+#include <unordered_map>
 #include "Config.h"
 #include "MemoryManager.h"
+#include "MemoryStampLog.h"
+#include "ready_queue.h"
+#include "host_placement.h"
 
 class Scheduler
 {
@@ -19,6 +24,9 @@ public:
     Scheduler(ProcessList &plist, Config &config, MemoryManager &memManager);
     void start();
     void stop();
+    // For background threads started outside the scheduler (clock ticker,
+    // console output, trace writer): pins them to the housekeeping CPUs
+    void pinHousekeeping(std::thread &thread) { pinThread(thread, placement.getHousekeepingCpus()); }
     void addProcess(const process &proc);
     void generateInstructionsForProcess(int pid);
     void startBatchGeneration();
@@ -26,8 +34,27 @@ public:
     int getNumCores() const { return numCores; }
     int getCoreAssignment(int core) const { return coreAssignments[core]; }
     MemoryManager& getMemoryManager() { return memoryManager; }
-	int getIdleTicks() const { return idleTicks; }
-    int getActiveTicks() const { return activeTicks; }
+	// Time cores spent without a process, in delay-per-exec ticks (at least 1 ms)
+	uint64_t getIdleTicks() const;
+    uint64_t getActiveTicks() const { return activeTicks.load(std::memory_order_relaxed); }
+    int getBusyCores() const { return busyCores.load(std::memory_order_relaxed); }
+    uint64_t getMigrations() const { return migrations.load(std::memory_order_relaxed); }
+    // Dispatches of a process onto a core, and the instructions they ran
+    uint64_t getContextSwitches() const { return contextSwitches.load(std::memory_order_relaxed); }
+    uint64_t getDispatchedInstructions() const { return dispatchedInstructions.load(std::memory_order_relaxed); }
+    const HostPlacement &getPlacement() const { return placement; }
+    std::vector<ReadyLevelStats> getReadyLevelStats();
+    std::vector<ReadyGroupStats> getReadyGroupStats();
+    ReadyDeadlineStats getReadyDeadlineStats();
+
+    // Processes finished since start and their mean time from
+    // addProcess to completion
+    struct TurnaroundStats
+    {
+        uint64_t finished;
+        double meanMs;
+    };
+    TurnaroundStats getTurnaroundStats();
 
 
 private:
@@ -37,26 +64,72 @@ private:
     int quantum;
     int numCores;
     std::atomic<int> processCounter{0};
-    int quantumCycle = 0; 
+    std::atomic<int> quantumCycle{0};
     int minMemPerProc, maxMemPerProc;
-	int idleTicks = 0;
-	int activeTicks = 0;
+    int batchDeadline; // ticks, 0: none
+    int migrationCost; // ticks charged when a process resumes on another core
+    HostPlacement placement;
+    void pinThread(std::thread &thread, const std::vector<int> &cpus);
+	std::atomic<uint64_t> idleNanos{0}; // finished idle periods
+	std::atomic<uint64_t> activeTicks{0};
+	std::atomic<int> busyCores{0}; // workers currently running a process
+	std::atomic<uint64_t> migrations{0};
+	std::atomic<uint64_t> contextSwitches{0};
+	std::atomic<uint64_t> dispatchedInstructions{0};
     void snapshotMemory(int cycle);
+    void retireProcess(int pid);
+    MemoryStampWriter memoryStampWriter;
+    uint64_t lastStampVersion = ~0ULL;
 
-    void schedulerThreadFunc();
+    bool waitForWork(int coreId, int &pid);
+    void enqueueLocked(const process &proc);
     void workerThreadFunc(int coreId);
+    void pagerThreadFunc();
+    void requestPage(int pid, int pageNum);
 
     SchedulerAlgorithm schedulerType;
     ProcessList &processList;
     MemoryManager &memoryManager;
     std::vector<std::thread> workers;
-    std::thread schedulerThread;
-    std::queue<int> readyQueue;
+    std::unique_ptr<ReadyQueue> readyQueue; // guarded by queueMutex
+    std::unordered_map<int, std::chrono::steady_clock::time_point> arrivals; // guarded by queueMutex
+    std::chrono::steady_clock::duration totalTurnaround{};                  // guarded by queueMutex
+    uint64_t finishedCount = 0;                                             // guarded by queueMutex
     std::mutex queueMutex;
-    std::condition_variable cv;
+    std::atomic<size_t> queuedCount{0}; // readyQueue->size(), for spinning cores
+
+    // Per-core idle state. Each core parks on its own condition variable so
+    // a push wakes exactly one core that can run the process.
+    struct IdleCore
+    {
+        static constexpr int kMinSpin = 16;
+        static constexpr int kMaxSpin = 4096;
+
+        std::condition_variable cv;
+        bool parked = false;               // guarded by queueMutex
+        int spinBudget = 256;              // yields before parking; owned by the worker
+        std::atomic<int64_t> since{0};     // steady_clock count when idling began, 0 while busy
+    };
+    std::unique_ptr<IdleCore[]> idleCores;
     std::atomic<bool> running;
     std::atomic<bool> batchGenerating = false;
     std::thread batchGeneratorThread;
     std::shared_ptr<Command> generateForBlock(int currentDepth, const std::string &procName);
     std::vector<int> coreAssignments; // coreAssignments[coreId] = pid or -1 if idle
+
+    // Deferred page faults: a faulting process is BLOCKED and handed to the
+    // pager thread, which loads the page after pageFaultLatency cycles and
+    // puts the process back on the ready queue.
+    struct PendingFault
+    {
+        std::chrono::steady_clock::time_point readyAt;
+        int pid;
+        int pageNum;
+        bool operator>(const PendingFault &other) const { return readyAt > other.readyAt; }
+    };
+    int pageFaultLatency;
+    std::thread pagerThread;
+    std::mutex pagerMutex;
+    std::condition_variable pagerCv;
+    std::priority_queue<PendingFault, std::vector<PendingFault>, std::greater<PendingFault>> pendingFaults;
 };
\ No newline at end of file
@@ -10,7 +10,7 @@ class process;
 #include <windows.h>
 #endif
 
-console::console(ProcessList &plist, const process &proc) : processList(plist), proc(proc), totalLines(100) {}
+console::console(ProcessList &plist, int pid) : processList(plist), pid(pid), totalLines(100) {}
 
 // Simulate inside-screen interaction
 void console::handleScreen()
@@ -21,10 +21,19 @@ void console::handleScreen()
     system("clear");
 #endif
 
-    std::cout << "=== Screen: " << proc.getProcessName() << " ===" << std::endl;
-    std::cout << "Process: " << proc.getProcessName() << std::endl;
-    std::cout << "Instruction: Line " << proc.getCurrentLine() << " / " << proc.getLineCount() << std::endl;
-    std::cout << "Created at: " << proc.getCreationTime() << std::endl;
+    // Only the slot's info and status are read, so this also works once the
+    // process has finished and been archived
+    ProcessInfo info;
+    ProcessStatus status;
+    if (!processList.getInfo(pid, info) || !processList.getStatus(pid, status))
+    {
+        std::cout << "Process not found." << std::endl;
+        return;
+    }
+    std::cout << "=== Screen: " << info.name << " ===" << std::endl;
+    std::cout << "Process: " << info.name << std::endl;
+    std::cout << "Instruction: Line " << status.currentLine << " / " << status.totalLines << std::endl;
+    std::cout << "Created at: " << CoarseClock::format(info.creationTime) << std::endl;
 
     std::string input;
     while (true)
@@ -43,23 +52,25 @@ void console::handleScreen()
         }
         else if (input == "process-smi")
         {
-            process latestProc = processList.findProcess(proc.getPid());
+            ProcessStatus latest;
+            processList.getStatus(pid, latest);
+            processList.getInfo(pid, info);
             std::cout
-                << "Process: " << latestProc.getProcessName() << "\n"
-                << "ID: " << latestProc.getPid() << "\n"
-                << "Current instruction line: " << latestProc.getCurrentLine() << "\n"
-                << "Lines of code: " << latestProc.getLineCount() << "\n"
-                << "Created at: " << latestProc.getCreationTime() << "\n";
+                << "Process: " << info.name << "\n"
+                << "ID: " << info.pid << "\n"
+                << "Current instruction line: " << latest.currentLine << "\n"
+                << "Lines of code: " << latest.totalLines << "\n"
+                << "Core migrations: " << latest.migrations << "\n"
+                << "Created at: " << CoarseClock::format(info.creationTime) << "\n";
+            if (info.finishTime != 0)
+                std::cout << "Finished at: " << CoarseClock::format(info.finishTime) << "\n";
 
-            const auto &logs = latestProc.getLogs();
+            std::string logs = processList.readLogs(pid);
 
             if (!logs.empty())
             {
                 std::cout << "\n--- Print Logs ---\n";
-                for (const auto &entry : logs)
-                {
-                    std::cout << entry;
-                }
+                std::cout << logs;
             }
 
             else
@@ -67,7 +78,7 @@ void console::handleScreen()
                 std::cout << "\nNo print logs found.\n";
             }
 
-            if (latestProc.getState() == ProcessState::FINISHED)
+            if (latest.state == ProcessState::FINISHED)
             {
                 std::cout << "\nFinished!" << std::endl;
             }
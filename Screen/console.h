@@ -8,10 +8,10 @@ class console
 {
 private:
     ProcessList &processList;
-    process proc;
+    int pid;
     int totalLines = 100;
 
 public:
-    console(ProcessList &plist, const process &proc);
+    console(ProcessList &plist, int pid);
     void handleScreen();
 };
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "console_sink.h"
+#include <chrono>
+#include <iostream>
+
+ConsoleSink &consoleSink()
+{
+	static ConsoleSink sink;
+	return sink;
+}
+
+ConsoleSink::ConsoleSink() : cells(new Cell[kCapacity])
+{
+	for (size_t i = 0; i < kCapacity; ++i)
+		cells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+ConsoleSink::~ConsoleSink()
+{
+	stop();
+}
+
+void ConsoleSink::start(const std::function<void(std::thread &)> &place)
+{
+	if (running.exchange(true))
+		return;
+	outputThread = std::thread(&ConsoleSink::outputThreadFunc, this);
+	if (place)
+		place(outputThread);
+}
+
+void ConsoleSink::stop()
+{
+	if (!running.exchange(false))
+		return;
+	if (outputThread.joinable())
+		outputThread.join();
+	flush();
+}
+
+bool ConsoleSink::post(std::string line)
+{
+	size_t pos = tail.load(std::memory_order_relaxed);
+	while (true)
+	{
+		Cell &cell = cells[pos & (kCapacity - 1)];
+		size_t sequence = cell.sequence.load(std::memory_order_acquire);
+		intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+		if (diff == 0)
+		{
+			if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+			{
+				cell.line = std::move(line);
+				cell.sequence.store(pos + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (diff < 0)
+		{
+			// Full: the output thread has not freed this cell yet
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		else
+		{
+			pos = tail.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+bool ConsoleSink::pop(std::string &line)
+{
+	Cell &cell = cells[head & (kCapacity - 1)];
+	if (cell.sequence.load(std::memory_order_acquire) != head + 1)
+		return false;
+
+	line = std::move(cell.line);
+	cell.line.clear();
+	cell.sequence.store(head + kCapacity, std::memory_order_release);
+	head++;
+	return true;
+}
+
+void ConsoleSink::flush()
+{
+	std::string batch;
+	std::string line;
+	size_t lines = 0;
+	uint64_t suppressed = 0;
+
+	// Only take what is queued now, so a steady stream cannot keep us here
+	size_t end = tail.load(std::memory_order_acquire);
+	while (head != end && pop(line))
+	{
+		if (lines < kMaxLinesPerFlush)
+		{
+			if (lines == 0)
+				batch += "\n";
+			batch += line;
+			lines++;
+		}
+		else
+		{
+			suppressed++;
+		}
+	}
+
+	suppressed += dropped.exchange(0, std::memory_order_relaxed);
+	if (suppressed > 0)
+		batch += "\n(" + std::to_string(suppressed) + " lines of output suppressed)\n";
+
+	if (batch.empty())
+		return;
+
+	batch += "Enter command: ";
+	std::cout.write(batch.data(), batch.size());
+	std::cout.flush();
+}
+
+void ConsoleSink::outputThreadFunc()
+{
+	while (running.load(std::memory_order_relaxed))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(kFlushIntervalMs));
+		flush();
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+// Console output from worker threads. Workers enqueue finished lines into a
+// bounded lock-free MPSC queue and return at once; a single output thread
+// drains it every kFlushInterval and writes each batch with one flush, so
+// lines from different cores never interleave mid-line.
+//
+// When the console cannot keep up the queue fills and further lines are
+// dropped; a batch also prints at most kMaxLinesPerFlush lines. Both are
+// reported as a one-line summary instead of stalling the workers.
+class ConsoleSink
+{
+public:
+	static constexpr size_t kCapacity = 4096; // power of two
+	static constexpr size_t kMaxLinesPerFlush = 64;
+	static constexpr int kFlushIntervalMs = 20;
+
+	ConsoleSink();
+	~ConsoleSink();
+	ConsoleSink(const ConsoleSink &) = delete;
+	ConsoleSink &operator=(const ConsoleSink &) = delete;
+
+	// place, if given, is called with the output thread once it exists
+	void start(const std::function<void(std::thread &)> &place = {});
+	void stop(); // drains what is queued before returning
+
+	// Never blocks; returns false if the line was dropped
+	bool post(std::string line);
+
+private:
+	struct Cell
+	{
+		std::atomic<size_t> sequence{0};
+		std::string line;
+	};
+
+	std::unique_ptr<Cell[]> cells;
+	alignas(64) std::atomic<size_t> tail{0}; // producers
+	alignas(64) size_t head = 0;             // output thread only
+	std::atomic<uint64_t> dropped{0};
+
+	std::atomic<bool> running{false};
+	std::thread outputThread;
+
+	bool pop(std::string &line);
+	void flush();
+	void outputThreadFunc();
+};
+
+// Shared by every worker thread
+ConsoleSink &consoleSink();
@@ -0,0 +1,69 @@
+// Offline reader for memory_stamp/memory_stamp.bin.
+//
+//   memstamp-dump <log>            regenerate memory_stamp/memory_stamp_<cycle>.txt for every cycle
+//   memstamp-dump <log> <cycle>    print the stamp for one cycle
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#define mkdir(path, mode) _mkdir(path)
+#endif
+#include "MemoryStampLog.h"
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        cerr << "Usage: memstamp-dump <log> [cycle]" << endl;
+        return 1;
+    }
+
+    MemoryStampReader reader(argv[1]);
+    if (!reader.isOpen())
+    {
+        cerr << "Could not read memory stamp log '" << argv[1] << "'" << endl;
+        return 1;
+    }
+
+    MemoryStamp stamp{};
+    if (argc >= 3)
+    {
+        int cycle = stoi(argv[2]);
+        bool found = false;
+        while (reader.next(stamp))
+        {
+            if (stamp.cycle == cycle)
+            {
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+        {
+            cerr << "Cycle " << cycle << " not found in log" << endl;
+            return 1;
+        }
+        cout << formatMemoryStamp(stamp, reader.getFrameSize(), reader.getMinMemPerProc());
+        return 0;
+    }
+
+    struct stat st = {0};
+    if (stat("memory_stamp", &st) == -1)
+    {
+        mkdir("memory_stamp", 0755);
+    }
+
+    int count = 0;
+    while (reader.next(stamp))
+    {
+        ofstream out("memory_stamp/memory_stamp_" + to_string(stamp.cycle) + ".txt");
+        out << formatMemoryStamp(stamp, reader.getFrameSize(), reader.getMinMemPerProc());
+        count++;
+    }
+    cout << "Wrote " << count << " memory stamps to memory_stamp/" << endl;
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Offline reader for csopesy-trace.bin.
+//
+//   trace-dump <trace>          print every log record of the run, in order
+//   trace-dump <trace> <pid>    print one process's log, following its chain
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "process_trace.h"
+
+using namespace std;
+
+static string renderEntry(const ProcessTraceReader::Entry &entry)
+{
+    string text = formatLogRecord(entry.record, entry.logTemplate);
+    if (!text.empty() && text.back() == '\n')
+        text.pop_back();
+    return text;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        cerr << "Usage: trace-dump <trace> [pid]" << endl;
+        return 1;
+    }
+
+    ProcessTraceReader reader(argv[1]);
+    if (!reader.isOpen())
+    {
+        cerr << "Could not read trace '" << argv[1] << "'" << endl;
+        return 1;
+    }
+
+    unordered_map<int, const ProcessTraceReader::PidInfo *> byPid;
+    for (const auto &info : reader.getPidIndex())
+        byPid[info.pid] = &info;
+
+    ProcessTraceReader::Entry entry;
+    if (argc >= 3)
+    {
+        int pid = stoi(argv[2]);
+        vector<int64_t> offsets;
+        auto it = byPid.find(pid);
+        if (it != byPid.end())
+        {
+            // Walk the chain backwards from the pid's last record
+            for (int64_t offset = it->second->lastOffset; offset >= 0 && reader.readAt(offset, entry);
+                 offset = entry.prevOffset)
+                offsets.push_back(offset);
+        }
+        else
+        {
+            // No index (the run did not exit cleanly): scan the whole trace
+            while (reader.next(entry))
+            {
+                if (entry.pid == pid)
+                    offsets.push_back(entry.offset);
+            }
+            reverse(offsets.begin(), offsets.end());
+        }
+
+        if (offsets.empty())
+        {
+            cerr << "No log records for pid " << pid << endl;
+            return 1;
+        }
+        if (it != byPid.end())
+            cout << "Process: " << it->second->name << " (pid " << pid << ", " << it->second->count << " records)\n";
+        for (auto offset = offsets.rbegin(); offset != offsets.rend(); ++offset)
+        {
+            reader.readAt(*offset, entry);
+            cout << renderEntry(entry) << "\n";
+        }
+        return 0;
+    }
+
+    while (reader.next(entry))
+    {
+        auto it = byPid.find(entry.pid);
+        cout << (it != byPid.end() ? it->second->name : "pid " + to_string(entry.pid))
+             << " line " << entry.record.line << ": " << renderEntry(entry) << "\n";
+    }
+    return 0;
+}